@@ -0,0 +1,86 @@
+#include "access_counters.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+static const char* accessNames[Access_COUNT] = {
+	"map_table_read",
+	"map_table_write",
+	"arch_map_table_write",
+	"free_list_pop",
+	"free_list_push",
+	"rob_write",
+	"rob_read",
+	"rs_write",
+	"wakeup_broadcast",
+	"wakeup_compare",
+	"fu_alu",
+	"fu_load",
+	"fu_store"
+};
+
+const char* getAccessName(AccessType type) {
+	return accessNames[type];
+}
+
+bool readEnergyTable(std::string path, EnergyTable& table) {
+	std::ifstream in(path);
+	if(!in.is_open()) {
+		std::cerr << "Cannot open energy table " << path << "\n";
+		return false;
+	}
+	for(int i = 0; i < Access_COUNT; i++)
+		table.perAccess[i] = 0;
+	std::string line;
+	for(int lineNumber = 1; std::getline(in, line); lineNumber++) {
+		std::istringstream fields(line.substr(0, line.find('#')));
+		std::string name;
+		if(!(fields >> name))
+			continue;
+		int type = 0;
+		while(type < Access_COUNT && name != accessNames[type])
+			type++;
+		double energy;
+		if(type == Access_COUNT || !(fields >> energy) || energy < 0) {
+			std::cerr << path << ":" << lineNumber << ": expected an access type and "
+					"its energy in picojoules\n";
+			return false;
+		}
+		table.perAccess[type] = energy;
+	}
+	return true;
+}
+
+double getDynamicEnergy(const AccessCounters& accesses, const EnergyTable& table) {
+	double energy = 0;
+	for(int i = 0; i < Access_COUNT; i++)
+		energy += accesses.counts[i] * table.perAccess[i];
+	return energy;
+}
+
+void writeAccessReport(std::ostream& out, const AccessCounters& accesses,
+		const EnergyTable* table, Cycle numCycles) {
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	out << std::left << std::setw(22) << "access" << std::right << std::setw(16) << "count";
+	if(table)
+		out << std::setw(18) << "energy (pJ)";
+	out << "\n";
+	out << std::fixed << std::setprecision(1);
+	for(int i = 0; i < Access_COUNT; i++) {
+		out << std::left << std::setw(22) << accessNames[i] << std::right <<
+				std::setw(16) << accesses.counts[i];
+		if(table)
+			out << std::setw(18) << accesses.counts[i] * table->perAccess[i];
+		out << "\n";
+	}
+	if(table) {
+		double energy = getDynamicEnergy(accesses, *table);
+		out << "dynamic energy: " << energy << " pJ over " << numCycles << " cycles\n";
+		out << std::scientific << std::setprecision(4);
+		out << "energy-delay product: " << energy * numCycles << " pJ*cycles\n";
+	}
+	out.flags(flags);
+	out.precision(precision);
+}
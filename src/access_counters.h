@@ -0,0 +1,84 @@
+#ifndef SRC_ACCESS_COUNTERS_H_
+#define SRC_ACCESS_COUNTERS_H_
+
+#include <ostream>
+#include <string>
+
+#include "utils.h"
+
+// Accesses to the pipeline's structures, as counted by BasicCPU.
+enum AccessType {
+	// Source and old destination lookups at dispatch.
+	Access_MAP_TABLE_READ,
+	// New mappings at dispatch and ready bits set at complete.
+	Access_MAP_TABLE_WRITE,
+	// Retirement map updates.
+	Access_ARCH_MAP_TABLE_WRITE,
+	Access_FREE_LIST_POP,
+	Access_FREE_LIST_PUSH,
+	// Entries allocated at dispatch and marked completed.
+	Access_ROB_WRITE,
+	// Head entries read at retire.
+	Access_ROB_READ,
+	Access_RS_WRITE,
+	// One per completing instruction, which every reservation station
+	// compares against both of its operand tags.
+	Access_WAKEUP_BROADCAST,
+	Access_WAKEUP_COMPARE,
+	// Functional unit activations, in RSType order.
+	Access_FU_ALU,
+	Access_FU_LOAD,
+	Access_FU_STORE,
+	Access_COUNT
+};
+
+// Name of an access type in energy tables and reports, such as
+// "map_table_read".
+const char* getAccessName(AccessType type);
+
+struct AccessCounters {
+	uint64_t counts[Access_COUNT];
+
+	void clear() {
+		for(int i = 0; i < Access_COUNT; i++)
+			counts[i] = 0;
+	}
+
+	void count(AccessType type, uint64_t n = 1) {
+		counts[type] += n;
+	}
+
+	void add(const AccessCounters& other) {
+		for(int i = 0; i < Access_COUNT; i++)
+			counts[i] += other.counts[i];
+	}
+
+	void subtract(const AccessCounters& other) {
+		for(int i = 0; i < Access_COUNT; i++)
+			counts[i] -= other.counts[i];
+	}
+
+	void multiply(uint64_t factor) {
+		for(int i = 0; i < Access_COUNT; i++)
+			counts[i] *= factor;
+	}
+};
+
+// Dynamic energy of one access of every type, in picojoules.
+struct EnergyTable {
+	double perAccess[Access_COUNT];
+};
+
+// Reads an energy table: one "access_name picojoules" pair per line, '#'
+// starting a comment. Access types left out cost nothing.
+bool readEnergyTable(std::string path, EnergyTable& table);
+
+// Total dynamic energy of the accesses, in picojoules.
+double getDynamicEnergy(const AccessCounters& accesses, const EnergyTable& table);
+
+// Lists the accesses, and with a table their energy, the total, and the
+// energy-delay product over numCycles cycles.
+void writeAccessReport(std::ostream& out, const AccessCounters& accesses,
+		const EnergyTable* table, Cycle numCycles);
+
+#endif /* SRC_ACCESS_COUNTERS_H_ */
@@ -0,0 +1,401 @@
+#include "batched_cpu.h"
+
+#include <algorithm>
+
+// The reservation stations of BasicCPU, in its order.
+#define NUM_STATIONS 4
+static const RSType stationTypes[NUM_STATIONS] = {
+	RSType_ALU, RSType_ALU, RSType_LOAD, RSType_STORE
+};
+static const uint32_t stationExecTimes[NUM_STATIONS] = { 1, 1, 2, 2 };
+
+BatchedCPU::BatchedCPU(const std::vector<CPUConfig>& configs) :
+	configs(configs), numLanes(configs.size()),
+	width(configs.empty() ? 1 : configs[0].width),
+	numArchRegs(configs.empty() ? 0 : configs[0].numArchRegs),
+	windowStart(0), fetchPtr(0), numDecoded(0), isFetching(false), cycle(0),
+	ringSize(1), timingHistory(false) {
+	uint32_t maxRobEntries = 1;
+	for(const CPUConfig& config : configs) {
+		if(!canBatch(config, configs[0])) {
+			std::cerr << __func__ << " given configurations of different widths or numArchRegs\n";
+			assert(false);
+		}
+		robEntries.push_back(config.robEntries);
+		maxRobEntries = std::max(maxRobEntries, config.robEntries);
+	}
+	// The RoB never holds more than robEntries instructions, so their
+	// numbers modulo ringSize are distinct.
+	while(ringSize < maxRobEntries)
+		ringSize *= 2;
+	numDispatched.resize(numLanes);
+	numRetired.resize(numLanes);
+	numFreeRegs.resize(numLanes);
+	numFreedRegs.resize(numLanes);
+	progress.resize(numLanes);
+	running.resize(numLanes);
+	finished.resize(numLanes);
+	stuck.resize(numLanes);
+	stopCycles.resize(numLanes);
+	stopFetched.resize(numLanes);
+	stopDecoded.resize(numLanes);
+	stationInstrs.resize(NUM_STATIONS * numLanes);
+	stationSrcs1.resize(NUM_STATIONS * numLanes);
+	stationSrcs2.resize(NUM_STATIONS * numLanes);
+	stationIssued.resize(NUM_STATIONS * numLanes);
+	issuedStations.resize(width * numLanes);
+	numIssued.resize(numLanes);
+	lastWriters.resize(numArchRegs * numLanes);
+	completeCycles.resize(ringSize * numLanes);
+	robWrites.resize(ringSize * numLanes);
+	completeQueue.resize(ringSize * numLanes);
+	completeQueueReady.resize(ringSize * numLanes);
+	completeQueueSize.resize(numLanes);
+	histories.resize(numLanes);
+	runningLanes.reserve(numLanes);
+	reset();
+}
+
+BatchedCPU::~BatchedCPU() {
+}
+
+void BatchedCPU::setTraceSource(TraceSource* source) {
+	if(cycle != 0) {
+		std::cerr << __func__ << " called after the simulation started\n";
+		assert(false);
+	}
+	if(!traceBuffer.setSource(source))
+		std::cerr << "Cannot read the trace from the start\n";
+	reset();
+}
+
+void BatchedCPU::setTimingHistory(bool enabled) {
+	if(cycle != 0) {
+		std::cerr << __func__ << " called after the simulation started\n";
+		assert(false);
+	}
+	timingHistory = enabled;
+	TraceSource* source = traceBuffer.getSource();
+	if(enabled && source != nullptr && source->size() != TRACE_SIZE_UNKNOWN) {
+		for(TimingHistory& history : histories)
+			history.reserve(traceBuffer.getSize());
+	}
+}
+
+void BatchedCPU::reset() {
+	if(traceBuffer.getSource() != nullptr && !traceBuffer.rewind())
+		std::cerr << "Cannot read the trace from the start\n";
+	windowStart = 0;
+	fetchPtr = 0;
+	numDecoded = 0;
+	cycle = 0;
+	TraceSource* source = traceBuffer.getSource();
+	if(source == nullptr)
+		isFetching = false;
+	else if(source->size() != TRACE_SIZE_UNKNOWN)
+		isFetching = traceBuffer.getSize() > 0;
+	else
+		isFetching = traceBuffer.has(0);
+	runningLanes.clear();
+	for(size_t lane = 0; lane < numLanes; lane++) {
+		const CPUConfig& config = configs[lane];
+		numDispatched[lane] = 0;
+		numRetired[lane] = 0;
+		numFreeRegs[lane] = config.numPhysicalRegs - config.numArchRegs;
+		numFreedRegs[lane] = 0;
+		numIssued[lane] = 0;
+		completeQueueSize[lane] = 0;
+		// Finished already if the trace is empty, as a CPU is.
+		running[lane] = isFetching;
+		finished[lane] = !isFetching;
+		stuck[lane] = false;
+		stopCycles[lane] = 0;
+		stopFetched[lane] = 0;
+		stopDecoded[lane] = 0;
+		if(running[lane])
+			runningLanes.push_back(lane);
+		histories[lane].clear();
+		if(timingHistory && source != nullptr && source->size() != TRACE_SIZE_UNKNOWN)
+			histories[lane].reserve(traceBuffer.getSize());
+	}
+	std::fill(stationInstrs.begin(), stationInstrs.end(), INSTR_NONE);
+	std::fill(lastWriters.begin(), lastWriters.end(), INSTR_NONE);
+}
+
+CPUStats BatchedCPU::getStats(size_t lane) const {
+	CPUStats stats;
+	stats.cycles = running[lane] ? cycle : stopCycles[lane];
+	stats.instructions = traceBuffer.getSize();
+	stats.fetched = running[lane] ? fetchPtr : stopFetched[lane];
+	stats.retired = numRetired[lane];
+	stats.finished = finished[lane];
+	stats.stuck = stuck[lane];
+	stats.extrapolatedCycles = 0;
+	return stats;
+}
+
+void BatchedCPU::collectTimings(size_t lane, TimingFile& timings) const {
+	const CPUConfig& config = configs[lane];
+	TimingFileHeader header;
+	header.numArchRegs = config.numArchRegs;
+	header.numPhysicalRegs = config.numPhysicalRegs;
+	header.robEntries = config.robEntries;
+	header.width = config.width;
+	header.numLSQEntries = config.numLSQEntries;
+	header.traceHash = traceBuffer.getHash();
+	timings.setHeader(header);
+
+	std::vector<TimingRow>& rows = timings.getRows();
+	InstrNum numInstructions = traceBuffer.getSize();
+	InstrNum fetched = running[lane] ? fetchPtr : stopFetched[lane];
+	InstrNum decoded = running[lane] ? numDecoded : stopDecoded[lane];
+	const TimingHistory& history = histories[lane];
+	rows.resize(numInstructions);
+	for(InstrNum i = 0; i < numInstructions; i++) {
+		if(i < history.size()) {
+			history.getRow(i, rows[i]);
+			continue;
+		}
+		// Not dispatched, so only the shared front end has seen it.
+		std::fill_n(rows[i].cycles, Stage_COUNT, CYCLE_UNSET);
+		if(i < fetched)
+			rows[i].cycles[Stage_FETCH] = i / width;
+		if(i < decoded)
+			rows[i].cycles[Stage_DECODE] = i / width + 1;
+	}
+	timings.getStallRows().clear();
+}
+
+void BatchedCPU::simulate() {
+	step(UINT64_MAX);
+}
+
+size_t BatchedCPU::step(Cycle numCycles) {
+	for(Cycle done = 0; done < numCycles && !runningLanes.empty(); done++)
+		tick();
+	return runningLanes.size();
+}
+
+void BatchedCPU::cancel(size_t lane) {
+	if(!running[lane])
+		return;
+	stop(lane);
+	runningLanes.erase(std::find(runningLanes.begin(), runningLanes.end(), lane));
+}
+
+void BatchedCPU::stop(size_t lane) {
+	running[lane] = false;
+	stopCycles[lane] = cycle;
+	stopFetched[lane] = fetchPtr;
+	stopDecoded[lane] = numDecoded;
+}
+
+void BatchedCPU::tick() {
+	// Registers freed by retire last cycle. Lanes that have stopped are
+	// never looked at again, so every lane goes.
+	for(size_t lane = 0; lane < numLanes; lane++) {
+		numFreeRegs[lane] += numFreedRegs[lane];
+		numFreedRegs[lane] = 0;
+	}
+	// Fetch and decode make progress for every lane alike.
+	char frontEndProgress = isFetching || numDecoded < fetchPtr;
+	std::fill(progress.begin(), progress.end(), frontEndProgress);
+	retire();
+	complete();
+	execute();
+	issue();
+	dispatch();
+	// Decode takes width a cycle like fetch, so it never falls behind.
+	numDecoded = fetchPtr;
+	fetch();
+	cycle++;
+	stopLanes();
+}
+
+void BatchedCPU::retire() {
+	size_t mask = ringSize - 1;
+	for(uint32_t lane : runningLanes) {
+		InstrNum head = numRetired[lane];
+		InstrNum end = std::min<InstrNum>(numDispatched[lane], head + width);
+		const Cycle* completed = &completeCycles[lane * ringSize];
+		const char* writes = &robWrites[lane * ringSize];
+		uint32_t numFreed = 0;
+		// Anything completed did so in an earlier cycle: complete comes next.
+		for(; head < end && completed[head & mask] != CYCLE_UNSET; head++) {
+			numFreed += writes[head & mask];
+			if(timingHistory)
+				histories[lane].setStageCycle(head, Stage_RETIRE, cycle);
+		}
+		if(head == numRetired[lane])
+			continue;
+		numRetired[lane] = head;
+		numFreedRegs[lane] = numFreed;
+		progress[lane] = true;
+	}
+}
+
+void BatchedCPU::complete() {
+	size_t mask = ringSize - 1;
+	for(uint32_t lane : runningLanes) {
+		uint32_t size = completeQueueSize[lane];
+		if(size == 0)
+			continue;
+		progress[lane] = true;
+		InstrNum* queue = &completeQueue[lane * ringSize];
+		Cycle* ready = &completeQueueReady[lane * ringSize];
+		Cycle* completed = &completeCycles[lane * ringSize];
+		// As in BasicCPU::complete(): width passes over the queue, each
+		// skipping the instruction behind one that completes.
+		for(uint32_t pass = 0; pass < width && size; pass++) {
+			for(uint32_t j = 0; j < size; j++) {
+				if(cycle < ready[j])
+					continue;
+				completed[queue[j] & mask] = cycle;
+				if(timingHistory)
+					histories[lane].setStageCycle(queue[j], Stage_COMPLETE, cycle);
+				std::copy(queue + j + 1, queue + size, queue + j);
+				std::copy(ready + j + 1, ready + size, ready + j);
+				size--;
+			}
+		}
+		completeQueueSize[lane] = size;
+	}
+}
+
+void BatchedCPU::execute() {
+	// Everything issued last cycle, as at most width are.
+	for(uint32_t lane : runningLanes) {
+		uint32_t count = numIssued[lane];
+		if(count == 0)
+			continue;
+		progress[lane] = true;
+		InstrNum* queue = &completeQueue[lane * ringSize];
+		Cycle* ready = &completeQueueReady[lane * ringSize];
+		uint32_t& size = completeQueueSize[lane];
+		for(uint32_t i = 0; i < count; i++) {
+			uint8_t station = issuedStations[lane * width + i];
+			InstrNum& instrNumber = stationInstrs[station * numLanes + lane];
+			queue[size] = instrNumber;
+			ready[size] = cycle + stationExecTimes[station];
+			size++;
+			if(timingHistory)
+				histories[lane].setStageCycle(instrNumber, Stage_EXECUTE, cycle);
+			instrNumber = INSTR_NONE;
+		}
+		numIssued[lane] = 0;
+	}
+}
+
+void BatchedCPU::issue() {
+	for(uint32_t lane : runningLanes) {
+		uint32_t count = 0;
+		for(uint32_t station = 0; station < NUM_STATIONS && count < width; station++) {
+			size_t i = station * numLanes + lane;
+			if(stationInstrs[i] == INSTR_NONE || stationIssued[i])
+				continue;
+			// Sources once done stay done, so they are not looked up again.
+			if(isDone(lane, stationSrcs1[i]))
+				stationSrcs1[i] = INSTR_NONE;
+			if(isDone(lane, stationSrcs2[i]))
+				stationSrcs2[i] = INSTR_NONE;
+			if(stationSrcs1[i] != INSTR_NONE || stationSrcs2[i] != INSTR_NONE)
+				continue;
+			stationIssued[i] = true;
+			issuedStations[lane * width + count++] = station;
+			if(timingHistory)
+				histories[lane].setStageCycle(stationInstrs[i], Stage_ISSUE, cycle);
+		}
+		numIssued[lane] = count;
+		if(count)
+			progress[lane] = true;
+	}
+}
+
+void BatchedCPU::dispatch() {
+	size_t mask = ringSize - 1;
+	for(uint32_t lane : runningLanes) {
+		InstrNum next = numDispatched[lane];
+		// Decoded in an earlier cycle, at most width, and room in the RoB.
+		InstrNum end = std::min<InstrNum>(std::min<InstrNum>(numDecoded, next + width),
+				numRetired[lane] + robEntries[lane]);
+		InstrNum* writers = &lastWriters[lane * numArchRegs];
+		for(; next < end && traceBuffer.has(next); next++) {
+			const StaticInstruction& inst = traceBuffer[next];
+			RSType type = inst.getReservationStation();
+			uint32_t station = 0;
+			while(station < NUM_STATIONS && (stationTypes[station] != type ||
+					stationInstrs[station * numLanes + lane] != INSTR_NONE))
+				station++;
+			if(station == NUM_STATIONS)
+				break;
+			bool writes = inst.dstOp != (uint32_t) -1;
+			if(writes && numFreeRegs[lane] == 0)
+				break;
+			size_t i = station * numLanes + lane;
+			stationInstrs[i] = next;
+			stationIssued[i] = false;
+			stationSrcs1[i] = inst.srcOp1 != (uint32_t) -1 ? writers[inst.srcOp1] : INSTR_NONE;
+			stationSrcs2[i] = inst.srcOp2 != (uint32_t) -1 ? writers[inst.srcOp2] : INSTR_NONE;
+			if(writes) {
+				writers[inst.dstOp] = next;
+				numFreeRegs[lane]--;
+			}
+			completeCycles[lane * ringSize + (next & mask)] = CYCLE_UNSET;
+			robWrites[lane * ringSize + (next & mask)] = writes;
+			if(timingHistory) {
+				TimingHistory& history = histories[lane];
+				history.addInstruction(next / width);
+				history.setStageCycle(next, Stage_DECODE, next / width + 1);
+				history.setStageCycle(next, Stage_DISPATCH, cycle);
+			}
+		}
+		if(next == numDispatched[lane])
+			continue;
+		numDispatched[lane] = next;
+		progress[lane] = true;
+	}
+}
+
+void BatchedCPU::fetch() {
+	if(!isFetching)
+		return;
+	// With the length known there is no need to read ahead; dispatch
+	// reads what it gets to.
+	if(traceBuffer.getSource()->size() != TRACE_SIZE_UNKNOWN) {
+		InstrNum size = traceBuffer.getSize();
+		fetchPtr = std::min<InstrNum>(fetchPtr + width, size);
+		isFetching = fetchPtr < size;
+		return;
+	}
+	for(uint32_t i = 0; i < width && isFetching; i++) {
+		if(!traceBuffer.has(fetchPtr)) {
+			isFetching = false;
+			break;
+		}
+		fetchPtr++;
+		if(!traceBuffer.has(fetchPtr))
+			isFetching = false;
+	}
+}
+
+void BatchedCPU::stopLanes() {
+	InstrNum oldest = fetchPtr;
+	size_t numRunning = 0;
+	for(uint32_t lane : runningLanes) {
+		// Instructions retire in order, so counting them is enough.
+		if(!isFetching && numRetired[lane] == fetchPtr)
+			finished[lane] = true;
+		else if(!progress[lane])
+			stuck[lane] = true;
+		else {
+			runningLanes[numRunning++] = lane;
+			oldest = std::min(oldest, numDispatched[lane]);
+			continue;
+		}
+		stop(lane);
+	}
+	runningLanes.resize(numRunning);
+	// Only running lanes look at the trace buffer.
+	for(; windowStart < oldest && windowStart < traceBuffer.getNumRead(); windowStart++)
+		traceBuffer.pop();
+}
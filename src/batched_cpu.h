@@ -0,0 +1,146 @@
+#ifndef SRC_BATCHED_CPU_H_
+#define SRC_BATCHED_CPU_H_
+
+#include <vector>
+
+#include "cpu.h"
+#include "timing_history.h"
+#include "trace_buffer.h"
+#include "utils.h"
+
+/*
+ * Simulates one trace on several configurations in lockstep, each in a
+ * lane of its own, giving every lane the timings and stats a CPU would
+ * give. Fetch and decode never stall, so for configurations with the same
+ * width and numArchRegs they do the same thing every cycle: the front end
+ * and the trace buffer are shared by all lanes. The back end of every lane
+ * is kept down to the counts and instruction numbers the timing depends
+ * on, stored by field across lanes, and each pipeline stage runs for every
+ * lane before the next one does.
+ *
+ *   BatchedCPU batch(configs);  // see canBatch()
+ *   batch.setTraceSource(source);
+ *   batch.simulate();
+ *   Cycle cycles = batch.getStats(2).cycles;
+ *
+ * Nothing but the timings and CPUStats is modelled: there is no debug log,
+ * no observers and no extrapolation.
+ */
+class BatchedCPU {
+	std::vector<CPUConfig> configs;
+	size_t numLanes;
+	uint32_t width;
+	uint32_t numArchRegs;
+
+	// Shared front end. The trace buffer holds instructions from the
+	// oldest one a running lane has not dispatched.
+	TraceBuffer traceBuffer;
+	InstrNum windowStart;
+	InstrNum fetchPtr;
+	InstrNum numDecoded;
+	bool isFetching;
+	Cycle cycle;
+
+	// Lanes that have neither finished, got stuck nor been cancelled.
+	std::vector<uint32_t> runningLanes;
+	// Per lane.
+	std::vector<uint32_t> robEntries;
+	// The RoB holds instructions numRetired to numDispatched - 1.
+	std::vector<InstrNum> numDispatched;
+	std::vector<InstrNum> numRetired;
+	std::vector<uint32_t> numFreeRegs;
+	// Freed by retire, back on the free list next cycle.
+	std::vector<uint32_t> numFreedRegs;
+	std::vector<char> progress;
+	std::vector<char> running;
+	std::vector<char> finished;
+	std::vector<char> stuck;
+	// Front end of a lane when it stopped.
+	std::vector<Cycle> stopCycles;
+	std::vector<InstrNum> stopFetched;
+	std::vector<InstrNum> stopDecoded;
+	// Reservation station s of lane l is at s * numLanes + l. Sources are
+	// the instructions producing them, INSTR_NONE if none.
+	std::vector<InstrNum> stationInstrs;
+	std::vector<InstrNum> stationSrcs1;
+	std::vector<InstrNum> stationSrcs2;
+	std::vector<char> stationIssued;
+	// Stations issued last cycle, in issue order, width per lane.
+	std::vector<uint8_t> issuedStations;
+	std::vector<uint32_t> numIssued;
+	// Last dispatched writer of every architectural register, numArchRegs
+	// per lane.
+	std::vector<InstrNum> lastWriters;
+	// Per lane, ringSize entries each: the complete cycle of the
+	// instructions in the RoB, by instruction number modulo ringSize, and
+	// whether they write a register, and the executed ones waiting to
+	// complete with the first cycle they can.
+	size_t ringSize;
+	std::vector<Cycle> completeCycles;
+	std::vector<char> robWrites;
+	std::vector<InstrNum> completeQueue;
+	std::vector<Cycle> completeQueueReady;
+	std::vector<uint32_t> completeQueueSize;
+	bool timingHistory;
+	std::vector<TimingHistory> histories;
+
+	bool isDone(size_t lane, InstrNum producer) const {
+		return producer == INSTR_NONE || producer < numRetired[lane] ||
+				completeCycles[lane * ringSize + (producer & (ringSize - 1))] != CYCLE_UNSET;
+	}
+
+	void tick();
+	void retire();
+	void complete();
+	void execute();
+	void issue();
+	void dispatch();
+	void fetch();
+	void stopLanes();
+	void stop(size_t lane);
+public:
+	// Every configuration must have the width and numArchRegs of the first.
+	BatchedCPU(const std::vector<CPUConfig>& configs);
+	virtual ~BatchedCPU();
+	BatchedCPU(const BatchedCPU&) = delete;
+	BatchedCPU& operator=(const BatchedCPU&) = delete;
+
+	// Whether a and b can share a BatchedCPU.
+	static bool canBatch(const CPUConfig& a, const CPUConfig& b) {
+		return a.width == b.width && a.numArchRegs == b.numArchRegs;
+	}
+
+	// source must outlive the BatchedCPU. Only before the simulation starts.
+	void setTraceSource(TraceSource* source);
+	// Keeps the stage timestamps of every instruction for collectTimings().
+	// Only before the simulation starts.
+	void setTimingHistory(bool enabled);
+
+	size_t size() const {
+		return numLanes;
+	}
+
+	size_t getNumRunning() const {
+		return runningLanes.size();
+	}
+
+	bool isRunning(size_t lane) const {
+		return running[lane];
+	}
+
+	CPUStats getStats(size_t lane) const;
+	// Needs setTimingHistory(true).
+	void collectTimings(size_t lane, TimingFile& timings) const;
+
+	// Runs until every lane has finished or got stuck.
+	void simulate();
+	// Runs the lanes still running for at most numCycles cycles and
+	// returns how many are still running.
+	size_t step(Cycle numCycles);
+	// Stops simulating lane until reset().
+	void cancel(size_t lane);
+	// Restarts every lane from cycle 0.
+	void reset();
+};
+
+#endif /* SRC_BATCHED_CPU_H_ */
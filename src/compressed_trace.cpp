@@ -0,0 +1,317 @@
+#include "compressed_trace.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#define COMPRESSED_TRACE_MAGIC_LEN 8
+#define COMPRESSED_TRACE_VERSION 1
+// Offsets of the header fields after the configuration.
+#define COMPRESSED_TRACE_COUNT_OFFSET 32
+#define COMPRESSED_TRACE_BLOCK_SIZE_OFFSET 40
+#define COMPRESSED_TRACE_NUM_BLOCKS_OFFSET 44
+#define COMPRESSED_TRACE_INDEX_OFFSET 48
+#define COMPRESSED_TRACE_HEADER_SIZE 56
+#define COMPRESSED_TRACE_INDEX_ENTRY_SIZE 12
+// Blocks decompressed ahead of the reader per worker thread.
+#define COMPRESSED_TRACE_SLOTS_PER_THREAD 2
+
+static void putFixed(std::string& buf, uint64_t value, int bytes) {
+	for(int i = 0; i < bytes; i++)
+		buf.push_back((char) ((value >> (8 * i)) & 0xff));
+}
+
+static uint64_t getFixed(const uint8_t* bytes, int size) {
+	uint64_t value = 0;
+	for(int i = 0; i < size; i++)
+		value |= (uint64_t) bytes[i] << (8 * i);
+	return value;
+}
+
+CompressedTraceSource::CompressedTraceSource() :
+	data(nullptr), dataSize(0), numInstructions(0), instructionsPerBlock(0),
+	pos(0), currentBlock(UINT64_MAX), stopping(false) {
+	memset(&config, 0, sizeof(config));
+}
+
+CompressedTraceSource::~CompressedTraceSource() {
+	stopWorkers();
+	if(data)
+		munmap((void*) data, dataSize);
+}
+
+bool CompressedTraceSource::open(std::string path, unsigned numThreads) {
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if(fd < 0) {
+		std::cerr << "Cannot open input file " << path << "\n";
+		return false;
+	}
+	struct stat st;
+	if(fstat(fd, &st) != 0 || st.st_size < COMPRESSED_TRACE_HEADER_SIZE) {
+		std::cerr << path << ": not a compressed trace\n";
+		close(fd);
+		return false;
+	}
+	dataSize = st.st_size;
+	void* mapped = mmap(nullptr, dataSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(mapped == MAP_FAILED) {
+		std::cerr << path << ": cannot map the trace\n";
+		dataSize = 0;
+		return false;
+	}
+	data = (const uint8_t*) mapped;
+
+	if(memcmp(data, COMPRESSED_TRACE_MAGIC, COMPRESSED_TRACE_MAGIC_LEN) != 0 ||
+			getFixed(data + COMPRESSED_TRACE_MAGIC_LEN, 4) != COMPRESSED_TRACE_VERSION) {
+		std::cerr << path << ": not a version " << COMPRESSED_TRACE_VERSION << " compressed trace\n";
+		return false;
+	}
+	uint32_t* fields[] = { &config.numArchRegs, &config.numPhysicalRegs,
+			&config.robEntries, &config.width, &config.numLSQEntries };
+	for(int i = 0; i < 5; i++)
+		*fields[i] = getFixed(data + 12 + 4 * i, 4);
+	numInstructions = getFixed(data + COMPRESSED_TRACE_COUNT_OFFSET, 8);
+	instructionsPerBlock = getFixed(data + COMPRESSED_TRACE_BLOCK_SIZE_OFFSET, 4);
+	uint64_t numBlocks = getFixed(data + COMPRESSED_TRACE_NUM_BLOCKS_OFFSET, 4);
+	uint64_t indexOffset = getFixed(data + COMPRESSED_TRACE_INDEX_OFFSET, 8);
+	if(instructionsPerBlock == 0 ||
+			numBlocks != (numInstructions + instructionsPerBlock - 1) / instructionsPerBlock ||
+			indexOffset > dataSize ||
+			(dataSize - indexOffset) / COMPRESSED_TRACE_INDEX_ENTRY_SIZE < numBlocks) {
+		std::cerr << path << ": corrupt compressed trace header\n";
+		numInstructions = 0;
+		return false;
+	}
+	index.resize(numBlocks);
+	for(uint64_t b = 0; b < numBlocks; b++) {
+		const uint8_t* entry = data + indexOffset + b * COMPRESSED_TRACE_INDEX_ENTRY_SIZE;
+		index[b].offset = getFixed(entry, 8);
+		index[b].compressedSize = getFixed(entry + 8, 4);
+		if(index[b].offset > indexOffset || indexOffset - index[b].offset < index[b].compressedSize) {
+			std::cerr << path << ": corrupt block index\n";
+			numInstructions = 0;
+			return false;
+		}
+	}
+
+	slots.resize(std::max(1u, numThreads) * COMPRESSED_TRACE_SLOTS_PER_THREAD);
+	for(Slot& slot : slots) {
+		slot.block = UINT64_MAX;
+		slot.state = SlotState_EMPTY;
+		slot.records.resize((size_t) instructionsPerBlock * TRACE_RECORD_SIZE);
+	}
+	for(unsigned i = 0; i < numThreads; i++)
+		workers.push_back(std::thread(&CompressedTraceSource::workerLoop, this));
+	pos = 0;
+	currentBlock = UINT64_MAX;
+	return true;
+}
+
+bool CompressedTraceSource::decompressBlock(uint64_t block, std::vector<uint8_t>& records) const {
+	uint64_t first = block * instructionsPerBlock;
+	uLongf size = std::min<InstrNum>(instructionsPerBlock, numInstructions - first) * TRACE_RECORD_SIZE;
+	uLongf expected = size;
+	return uncompress(records.data(), &size, data + index[block].offset,
+			index[block].compressedSize) == Z_OK && size == expected;
+}
+
+void CompressedTraceSource::workerLoop() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while(!stopping) {
+		Slot* slot = nullptr;
+		for(Slot& s : slots) {
+			if(s.state == SlotState_PENDING) {
+				slot = &s;
+				break;
+			}
+		}
+		if(slot == nullptr) {
+			workAvailable.wait(lock);
+			continue;
+		}
+		slot->state = SlotState_WORKING;
+		uint64_t block = slot->block;
+		lock.unlock();
+		bool ok = decompressBlock(block, slot->records);
+		lock.lock();
+		// The reader may have moved the slot on to another block meanwhile.
+		if(slot->block != block)
+			slot->state = SlotState_PENDING;
+		else
+			slot->state = ok ? SlotState_READY : SlotState_ERROR;
+		workDone.notify_all();
+	}
+}
+
+void CompressedTraceSource::stopWorkers() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	workAvailable.notify_all();
+	for(std::thread& worker : workers)
+		worker.join();
+	workers.clear();
+}
+
+// Makes block the oldest one kept and queues the ones after it.
+void CompressedTraceSource::schedule(uint64_t block) {
+	currentBlock = block;
+	std::lock_guard<std::mutex> lock(mutex);
+	for(uint64_t b = block; b < block + slots.size() && b < index.size(); b++) {
+		Slot& slot = slots[b % slots.size()];
+		if(slot.block == b)
+			continue;
+		slot.block = b;
+		// A worker still busy with the old block requeues the slot itself.
+		if(slot.state != SlotState_WORKING)
+			slot.state = SlotState_PENDING;
+	}
+	workAvailable.notify_all();
+}
+
+const CompressedTraceSource::Slot* CompressedTraceSource::waitForBlock(uint64_t block) {
+	Slot& slot = slots[block % slots.size()];
+	if(workers.empty()) {
+		// Nothing can touch the slots but this thread.
+		if(slot.state == SlotState_PENDING)
+			slot.state = decompressBlock(block, slot.records) ? SlotState_READY : SlotState_ERROR;
+		return slot.state == SlotState_READY ? &slot : nullptr;
+	}
+	std::unique_lock<std::mutex> lock(mutex);
+	while(slot.state != SlotState_READY && slot.state != SlotState_ERROR)
+		workDone.wait(lock);
+	return slot.state == SlotState_READY ? &slot : nullptr;
+}
+
+size_t CompressedTraceSource::read(StaticInstruction* batch, size_t maxCount) {
+	size_t count = 0;
+	while(count < maxCount && pos < numInstructions) {
+		uint64_t block = pos / instructionsPerBlock;
+		if(block != currentBlock)
+			schedule(block);
+		const Slot* slot = waitForBlock(block);
+		if(slot == nullptr) {
+			std::cerr << "Cannot decompress block " << block << " of the trace\n";
+			// Workers read numInstructions; the trace ends here anyway.
+			stopWorkers();
+			numInstructions = pos;
+			break;
+		}
+		InstrNum blockEnd = std::min<InstrNum>((block + 1) * instructionsPerBlock, numInstructions);
+		const uint8_t* record = slot->records.data() +
+				(pos - block * instructionsPerBlock) * TRACE_RECORD_SIZE;
+		for(; count < maxCount && pos < blockEnd; count++, pos++, record += TRACE_RECORD_SIZE) {
+			if(!decodeTraceRecord(record, batch[count])) {
+				std::cerr << "Unsupported type " << getFixed(record, 4) << " of instruction " << pos << "\n";
+				stopWorkers();
+				numInstructions = pos;
+				return count;
+			}
+		}
+	}
+	return count;
+}
+
+bool CompressedTraceSource::rewind() {
+	return seek(0);
+}
+
+bool CompressedTraceSource::seek(InstrNum instrNumber) {
+	if(data == nullptr || instrNumber > numInstructions)
+		return false;
+	// Blocks already decompressed stay in their slots; read() schedules
+	// the new position when it gets there.
+	pos = instrNumber;
+	return true;
+}
+
+bool CompressedTraceSource::getConfig(CPUConfig& config) const {
+	config = this->config;
+	return true;
+}
+
+CompressedTraceWriter::CompressedTraceWriter() :
+	instructionsPerBlock(0), level(Z_DEFAULT_COMPRESSION), offset(0),
+	numInstructions(0), numBlocks(0) {
+}
+
+CompressedTraceWriter::~CompressedTraceWriter() {
+}
+
+bool CompressedTraceWriter::open(std::string path, const CPUConfig& config,
+		uint32_t instructionsPerBlock, int level) {
+	assert(instructionsPerBlock > 0);
+	this->instructionsPerBlock = instructionsPerBlock;
+	this->level = level;
+	out.open(path, std::ios::binary);
+	if(!out.is_open()) {
+		std::cerr << "Cannot open trace file " << path << " to write!\n";
+		return false;
+	}
+	std::string header(COMPRESSED_TRACE_MAGIC);
+	putFixed(header, COMPRESSED_TRACE_VERSION, 4);
+	putFixed(header, config.numArchRegs, 4);
+	putFixed(header, config.numPhysicalRegs, 4);
+	putFixed(header, config.robEntries, 4);
+	putFixed(header, config.width, 4);
+	putFixed(header, config.numLSQEntries, 4);
+	// The counts and the index offset are patched by close().
+	header.resize(COMPRESSED_TRACE_HEADER_SIZE, 0);
+	out.write(header.data(), header.size());
+	offset = COMPRESSED_TRACE_HEADER_SIZE;
+	records.clear();
+	records.reserve((size_t) instructionsPerBlock * TRACE_RECORD_SIZE);
+	index.clear();
+	numInstructions = 0;
+	numBlocks = 0;
+	return true;
+}
+
+bool CompressedTraceWriter::flushBlock() {
+	if(records.empty())
+		return true;
+	uLongf size = compressBound(records.size());
+	compressed.resize(size);
+	if(compress2(compressed.data(), &size, (const Bytef*) records.data(),
+			records.size(), level) != Z_OK) {
+		std::cerr << "Cannot compress trace block " << numBlocks << "\n";
+		return false;
+	}
+	out.write((const char*) compressed.data(), size);
+	putFixed(index, offset, 8);
+	putFixed(index, size, 4);
+	offset += size;
+	numBlocks++;
+	records.clear();
+	return true;
+}
+
+bool CompressedTraceWriter::addInstruction(const StaticInstruction& inst) {
+	uint8_t record[TRACE_RECORD_SIZE];
+	encodeTraceRecord(inst, record);
+	records.append((const char*) record, TRACE_RECORD_SIZE);
+	numInstructions++;
+	if(records.size() == (size_t) instructionsPerBlock * TRACE_RECORD_SIZE)
+		return flushBlock();
+	return true;
+}
+
+bool CompressedTraceWriter::close() {
+	if(!flushBlock())
+		return false;
+	out.write(index.data(), index.size());
+	std::string header;
+	putFixed(header, numInstructions, 8);
+	putFixed(header, instructionsPerBlock, 4);
+	putFixed(header, numBlocks, 4);
+	putFixed(header, offset, 8);
+	out.seekp(COMPRESSED_TRACE_COUNT_OFFSET);
+	out.write(header.data(), header.size());
+	out.close();
+	return !out.fail();
+}
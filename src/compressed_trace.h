@@ -0,0 +1,119 @@
+#ifndef SRC_COMPRESSED_TRACE_H_
+#define SRC_COMPRESSED_TRACE_H_
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trace_source.h"
+
+#define COMPRESSED_TRACE_MAGIC "R10KTRCZ"
+
+/*
+ * Trace split into blocks of a fixed number of instructions, each
+ * compressed on its own with zlib so that any block can be read without
+ * the ones before it:
+ *
+ *   "R10KTRCZ" | version | config | #instructions | instructions per
+ *   block | #blocks | index offset
+ *   then the compressed blocks, then the index: for every block, its
+ *   file offset (64 bits) and compressed size (32 bits).
+ *
+ * Blocks hold the 16-byte records of the binary trace format. Fields are
+ * little-endian and 32 bits wide unless noted otherwise.
+ */
+class CompressedTraceSource : public TraceSource {
+	enum SlotState {
+		SlotState_EMPTY,
+		SlotState_PENDING,
+		SlotState_WORKING,
+		SlotState_READY,
+		SlotState_ERROR
+	};
+	// A decompressed block, or one being worked on.
+	struct Slot {
+		uint64_t block;
+		SlotState state;
+		std::vector<uint8_t> records;
+	};
+	struct BlockIndexEntry {
+		uint64_t offset;
+		uint32_t compressedSize;
+	};
+
+	const uint8_t* data;
+	size_t dataSize;
+	CPUConfig config;
+	InstrNum numInstructions;
+	uint32_t instructionsPerBlock;
+	std::vector<BlockIndexEntry> index;
+	InstrNum pos;
+	// Block the slots are currently scheduled from, UINT64_MAX for none.
+	uint64_t currentBlock;
+
+	// Blocks currentBlock .. currentBlock + slots.size() - 1 live in
+	// slots[block % slots.size()]. Workers decompress PENDING slots; the
+	// reader waits for READY ones.
+	std::vector<Slot> slots;
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable workAvailable;
+	std::condition_variable workDone;
+	bool stopping;
+
+	bool decompressBlock(uint64_t block, std::vector<uint8_t>& records) const;
+	void schedule(uint64_t block);
+	const Slot* waitForBlock(uint64_t block);
+	void workerLoop();
+	void stopWorkers();
+public:
+	CompressedTraceSource();
+	virtual ~CompressedTraceSource();
+	CompressedTraceSource(const CompressedTraceSource&) = delete;
+	CompressedTraceSource& operator=(const CompressedTraceSource&) = delete;
+
+	// numThreads workers decompress ahead of the reader; with 0 the
+	// reader decompresses each block when it gets to it.
+	bool open(std::string path, unsigned numThreads);
+
+	size_t read(StaticInstruction* batch, size_t maxCount);
+	bool rewind();
+	bool seek(InstrNum instrNumber);
+
+	InstrNum size() const {
+		return numInstructions;
+	}
+
+	bool getConfig(CPUConfig& config) const;
+};
+
+// Writes the format read by CompressedTraceSource.
+class CompressedTraceWriter {
+	std::ofstream out;
+	uint32_t instructionsPerBlock;
+	int level;
+	// Records of the block being filled, and its compressed form.
+	std::string records;
+	std::vector<uint8_t> compressed;
+	std::string index;
+	uint64_t offset;
+	InstrNum numInstructions;
+	uint32_t numBlocks;
+
+	bool flushBlock();
+public:
+	CompressedTraceWriter();
+	virtual ~CompressedTraceWriter();
+
+	// level is the zlib compression level, 1 (fast) to 9 (small).
+	bool open(std::string path, const CPUConfig& config,
+			uint32_t instructionsPerBlock, int level);
+	bool addInstruction(const StaticInstruction& inst);
+	// Writes the index; returns false on write errors.
+	bool close();
+};
+
+#endif /* SRC_COMPRESSED_TRACE_H_ */
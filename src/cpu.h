@@ -1,14 +1,67 @@
 #ifndef SRC_CPU_H_
 #define SRC_CPU_H_
 
+#include "cpu_config.h"
 #include "free_list.h"
+#include "interval_log.h"
+#include "latency_stats.h"
+#include "instruction_pool.h"
+#include "instruction_trace.h"
 #include "pipeline_stage.h"
 #include "mapping_table.h"
+#include "pipeline_counters.h"
+#include "pipeline_observer.h"
+#include "register_hot_spots.h"
 #include "reorder_buffer.h"
 #include "reservation_station.h"
+#include "slack_stats.h"
+#include "stats_page.h"
+#include "steady_state.h"
+#include "timing_file.h"
+#include "timing_history.h"
+#include "trace_buffer.h"
+#include "trace_source.h"
 #include "utils.h"
+#include "window_stats.h"
 
-class CPU {
+// Counters describing how far a simulation has got.
+struct CPUStats {
+	Cycle cycles;
+	// Instructions in the trace, and how many of them were fetched, and
+	// retired so far.
+	InstrNum instructions;
+	InstrNum fetched;
+	InstrNum retired;
+	// Every instruction has retired.
+	bool finished;
+	// The last cycle made no progress, so the pipeline is deadlocked.
+	bool stuck;
+	// Cycles, out of cycles, that were extrapolated rather than simulated.
+	Cycle extrapolatedCycles;
+
+	double getIPC() const {
+		return cycles ? (double) retired / cycles : 0;
+	}
+};
+
+/*
+ * The simulator. Typical use as a library:
+ *
+ *   CPU cpu(config);
+ *   cpu.setTrace(trace);        // or addInstruction() one at a time,
+ *                               // or setTraceSource() to stream it
+ *   cpu.step(1000);             // or runUntil(n), or simulate()
+ *   CPUStats stats = cpu.getStats();
+ *   cpu.reset(otherConfig);     // rerun the same trace
+ *
+ * Nothing is logged unless setDebugLog() is given a stream.
+ *
+ * Pipeline events are reported to an Observer policy (see
+ * pipeline_observer.h). CPU uses NullObserver, which costs nothing;
+ * ObservedCPU forwards to observers registered at runtime.
+ */
+template <class Observer>
+class BasicCPU {
 	uint32_t numArchRegs;
 	uint32_t numPhysicalRegs;
 	uint32_t robEntries;
@@ -18,18 +71,28 @@ class CPU {
 	MappingTable mapTable;
 	ReorderBuffer rob;
 	FreeList freeList;
-	std::deque <PhysicalRegister> freePhysRegsPrevCycle;
+	// Reserved to width entries, the most retire() can free in a cycle.
+	std::vector<PhysicalRegister> freePhysRegsPrevCycle;
 	PipelineStage fetchStage;
-	PipelineStage decodeStage;
-	PipelineStage dispatchStage;
+	// Fetch, decode and dispatch are in order; instructions get an
+	// Instruction record from instructionPool once they are dispatched.
+	InOrderStage decodeStage;
+	InOrderStage dispatchStage;
 	PipelineStage issueStage;
 	PipelineStage executeStage;
 	PipelineStage completeStage;
 	PipelineStage retireStage;
 	std::vector<ReservationStation*> reservationStations;
 
-	std::vector<Instruction*> instructionsList;
-	uint32_t fetchPtr;
+	// The built-in trace, simulated unless a TraceSource is attached.
+	InstructionTrace trace;
+	MemoryTraceSource memorySource;
+	// Fetched instructions wait here until they are dispatched.
+	TraceBuffer traceBuffer;
+	TimingHistory history;
+	InstructionPool instructionPool;
+	InstrNum fetchPtr;
+	InstrNum numRetired;
 
 	// Track if we are currently fetching an instruction.
 	// Used to detect when we have finished scheduling all instructions.
@@ -40,19 +103,219 @@ class CPU {
 	bool hasProgress;
 
 	// Start from cycle 0.
-	uint32_t cycle;
+	Cycle cycle;
+
+	// Per-cycle trace of the pipeline, or nullptr for none.
+	std::ostream* debugLog;
+
+	// Skip repeating loop iterations, see setExtrapolation().
+	bool extrapolation;
+	SteadyStateDetector steadyState;
+	Cycle extrapolatedCycles;
+
+	// Published every statsInterval cycles, see setStatsPage().
+	StatsPage* statsPage;
+	Cycle statsInterval;
+	Cycle nextStatsUpdate;
+	// Written every recordInterval cycles, see setIntervalLog().
+	IntervalLog* intervalLog;
+	Cycle recordInterval;
+	Cycle nextIntervalRecord;
+	// The earlier of the two, UINT64_MAX when neither is used, which keeps
+	// the check per cycle to a single comparison.
+	Cycle nextReport;
+
+	PipelineCounters counters;
+
+	// Why instructions waited, see setStallAttribution().
+	bool stallAttribution;
+	// One row per dispatched instruction.
+	std::vector<StallRow> stallHistory;
+	// The instruction writing every physical register, INSTR_NONE for the
+	// initial mappings.
+	std::vector<InstrNum> regProducer;
+	// Dispatch stalls so far at every cycle that decoded instructions,
+	// from instruction firstInstr on, while any of them waits to dispatch:
+	// the entries from firstDecodeStalls on. The ones before it are
+	// dropped once they take up half the vector, rather than growing it.
+	struct DecodeStalls {
+		InstrNum firstInstr;
+		uint64_t stalls[StallReason_COUNT];
+	};
+	std::vector<DecodeStalls> decodeStalls;
+	size_t firstDecodeStalls;
+	// The retired instruction that completed last, and when.
+	InstrNum lastCompleter;
+	Cycle lastCompleteCycle;
+	// Told about every retired instruction, see setLatencyStats().
+	LatencyStats* latencyStats;
+	// Told which registers instructions waited on, see
+	// setRegisterHotSpots(); regReadyCycle holds the cycle every physical
+	// register last became ready.
+	RegisterHotSpots* registerHotSpots;
+	std::vector<Cycle> regReadyCycle;
+	// Sampled every cycle, see setWindowStats(); windowDepth holds the
+	// dependency depth of the value in every physical register written in
+	// the window.
+	WindowStats* windowStats;
+	std::vector<uint32_t> windowDepth;
+	// Told about every retired instruction, see setSlackStats().
+	SlackStats* slackStats;
+
+	Observer observer;
+
+	void logStage(const char* stage, const Instruction& inst);
+	void logStage(const char* stage, InstrNum instrNumber);
+	void logState();
+	void buildStateKey();
+	// Instructions fetched after numCycles more cycles, and in
+	// numDecoded, how many of them have been decoded by then.
+	InstrNum fetchedAfter(Cycle numCycles, InstrNum& numDecoded);
+	// Skips whole periods if the pipeline is in a steady state, at most
+	// maxCycles cycles and up to retireLimit retired instructions.
+	bool extrapolate(Cycle maxCycles, InstrNum retireLimit);
+	void updateStatsPage();
+	// Updates the stats page and interval log if they are due, or, when
+	// step() or runUntil() are returning, the stats page regardless and the
+	// interval log if the simulation is over.
+	void report(bool returning);
+	void attributeDispatch(InstrNum instrNumber, const PhysicalRegister& T);
+	void attributeIssue(Instruction* inst);
+	void attributeRetire(Instruction* inst);
+	void countRegisterWait(Instruction* inst);
+	void sampleWindow();
 public:
-	CPU(uint32_t numArchRegs, uint32_t numPhysicalRegs,
+	BasicCPU(const CPUConfig& config);
+	BasicCPU(uint32_t numArchRegs, uint32_t numPhysicalRegs,
 			uint32_t robEntries, uint32_t width, uint32_t numLSQEntries);
-	virtual ~CPU();
+	virtual ~BasicCPU();
+	BasicCPU(const BasicCPU&) = delete;
+	BasicCPU& operator=(const BasicCPU&) = delete;
 
+	// Appends to the built-in trace.
 	void addInstruction(char type, uint32_t srcOp1, uint32_t srcOp2, uint32_t dstOp);
+	// Replaces the trace; only valid before the simulation has started.
+	void setTrace(const InstructionTrace& trace);
+	// Streams the trace from source instead, which must outlive the
+	// simulation; nullptr goes back to the built-in trace. Simulation
+	// starts at instruction firstInstruction of the source, which becomes
+	// instruction 0, and reset() seeks back there.
+	void setTraceSource(TraceSource* source, InstrNum firstInstruction = 0);
 
+	// The built-in trace, which is ignored while a TraceSource is attached.
+	const InstructionTrace& getTrace() const {
+		return trace;
+	}
+
+	// Runs until every instruction has retired or the pipeline is stuck.
 	void simulate();
-	bool isFinished();
+	// Runs at most numCycles cycles and returns how many were simulated.
+	Cycle step(Cycle numCycles);
+	// Runs until instruction instrNumber has retired, returning false if
+	// the simulation ended first.
+	bool runUntil(InstrNum instrNumber);
+	bool isFinished() const;
+
+	// Restarts the trace from cycle 0, optionally on another machine.
+	void reset();
+	void reset(const CPUConfig& config);
+
+	CPUConfig getConfig() const;
+	CPUStats getStats() const;
 
+	const TimingHistory& getHistory() const {
+		return history;
+	}
+
+	// Accesses to every structure since the last reset(), for energy
+	// estimates (see access_counters.h).
+	const AccessCounters& getAccessCounters() const {
+		return counters.accesses;
+	}
+
+	const PipelineCounters& getCounters() const {
+		return counters;
+	}
+
+	/*
+	 * Simulates one cycle and moves on to the next. Once warmed up, it
+	 * does not allocate if the trace source knows its length. Otherwise
+	 * the timing history, and the stall history and SlackStats if used,
+	 * double whenever they fill up, a logarithmic number of allocations
+	 * over the trace. So do the trace buffer and, with stall attribution,
+	 * the dispatch stalls kept per decode cycle, when the front end gets
+	 * further ahead of dispatch than it ever did, and the heap of
+	 * LatencyStats, until it holds all the slowest instructions asked for.
+	 */
 	void tick();
 
+	void setDebugLog(std::ostream* debugLog) {
+		this->debugLog = debugLog;
+	}
+
+	/*
+	 * Once the pipeline gets back into an earlier state while the trace
+	 * repeats itself, as in the body of a loop, the following iterations
+	 * are timed by shifting the last one rather than simulated. Falls back
+	 * to simulating as soon as the trace stops repeating. Timestamps are
+	 * the same as without extrapolation, but observers and the debug log
+	 * are not told about skipped cycles, and physical register numbers may
+	 * differ afterwards. Off by default.
+	 */
+	void setExtrapolation(bool enabled);
+
+	// Publishes progress to page, which must outlive the simulation, every
+	// interval cycles and whenever step() or runUntil() return. Snapshots
+	// requested through the page are written at the next update. nullptr
+	// stops publishing.
+	void setStatsPage(StatsPage* page, Cycle interval = STATS_PAGE_DEFAULT_INTERVAL);
+	// Writes a record of the last interval to log, which must outlive the
+	// simulation, every interval cycles and when the simulation ends.
+	// nullptr stops recording.
+	void setIntervalLog(IntervalLog* log, Cycle interval = INTERVAL_LOG_DEFAULT_CYCLES);
+	/*
+	 * Records why every instruction waited (see StallRow): what stalled
+	 * dispatch most while it was waiting to be dispatched, which operand
+	 * and producer it issued after, and which older instruction held up
+	 * its retirement. Written to the text output file after the
+	 * timestamps. Only valid before the simulation has started; turns
+	 * extrapolation off.
+	 */
+	void setStallAttribution(bool enabled);
+
+	const std::vector<StallRow>& getStallHistory() const {
+		return stallHistory;
+	}
+
+	// Adds every instruction to stats as it retires; stats must outlive the
+	// simulation. Turns extrapolation off. nullptr stops adding.
+	void setLatencyStats(LatencyStats* stats) {
+		latencyStats = stats;
+	}
+
+	// Reports the architectural registers instructions waited on to
+	// hotSpots, which must outlive the simulation. Only valid before the
+	// simulation has started; turns extrapolation off.
+	void setRegisterHotSpots(RegisterHotSpots* hotSpots);
+	// Adds the ready instructions and the longest dependency chain in the
+	// window to stats every cycle; stats must outlive the simulation. Only
+	// valid before the simulation has started; turns extrapolation off.
+	void setWindowStats(WindowStats* stats);
+	// Adds every instruction to stats as it retires, for the slack of each
+	// to be worked out at the end; stats must outlive the simulation. Only
+	// valid before the simulation has started, since the dependencies of
+	// every instruction are needed; turns extrapolation off.
+	void setSlackStats(SlackStats* stats);
+	// The whole pipeline state as JSON.
+	void writeSnapshot(std::ostream& out);
+
+	Observer& getObserver() {
+		return observer;
+	}
+
+	// Records that inst entered stage in the current cycle.
+	void enterStage(Instruction* inst, TimingStage stage);
+
 	void fetch();
 	void decode();
 	void dispatch();
@@ -61,9 +324,18 @@ public:
 	void complete();
 	void retire();
 
+	void collectTimings(TimingFile& timings);
 	void generateOutputFile(std::string outputFile);
+	void generateBinaryOutputFile(std::string outputFile);
 
 	std::string toString();
 };
 
+typedef BasicCPU<NullObserver> CPU;
+typedef BasicCPU<ObserverList> ObservedCPU;
+
+// Both are compiled once, in cpu.cpp.
+extern template class BasicCPU<NullObserver>;
+extern template class BasicCPU<ObserverList>;
+
 #endif /* SRC_CPU_H_ */
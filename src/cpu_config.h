@@ -0,0 +1,15 @@
+#ifndef SRC_CPU_CONFIG_H_
+#define SRC_CPU_CONFIG_H_
+
+#include "utils.h"
+
+// Machine parameters, as given on the first line of an input file.
+struct CPUConfig {
+	uint32_t numArchRegs;
+	uint32_t numPhysicalRegs;
+	uint32_t robEntries;
+	uint32_t width;
+	uint32_t numLSQEntries;
+};
+
+#endif /* SRC_CPU_CONFIG_H_ */
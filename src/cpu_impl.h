@@ -0,0 +1,1249 @@
+#ifndef SRC_CPU_IMPL_H_
+#define SRC_CPU_IMPL_H_
+
+// Member definitions of BasicCPU. cpu.cpp instantiates the NullObserver
+// and ObserverList policies; include this file to instantiate others.
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include "cpu.h"
+#include "probes.h"
+
+template <class Observer>
+BasicCPU<Observer>::BasicCPU(const CPUConfig& config) :
+	numArchRegs(config.numArchRegs), numPhysicalRegs(config.numPhysicalRegs),
+	robEntries(config.robEntries), width(config.width), numLSQEntries(config.numLSQEntries),
+	archMappingTable("archMapTable", numArchRegs, numPhysicalRegs),
+	mapTable("Mapping Table", numArchRegs, numPhysicalRegs),
+	rob(robEntries), freeList(numArchRegs, numPhysicalRegs),
+	fetchStage("fetch", width),
+	decodeStage("decode"),
+	dispatchStage("dispatch"),
+	issueStage("issue", width),
+	executeStage("execute", width),
+	completeStage("complete", width),
+	retireStage("retire", width),
+	memorySource(trace),
+	instructionPool(robEntries),
+	fetchPtr(0), numRetired(0), isFetching(false),
+	hasProgress(true), cycle(0), debugLog(nullptr),
+	extrapolation(false), extrapolatedCycles(0),
+	statsPage(nullptr), statsInterval(STATS_PAGE_DEFAULT_INTERVAL), nextStatsUpdate(UINT64_MAX),
+	intervalLog(nullptr), recordInterval(INTERVAL_LOG_DEFAULT_CYCLES),
+	nextIntervalRecord(UINT64_MAX), nextReport(UINT64_MAX),
+	stallAttribution(false), firstDecodeStalls(0), lastCompleter(INSTR_NONE),
+	lastCompleteCycle(0),
+	latencyStats(nullptr), registerHotSpots(nullptr), windowStats(nullptr),
+	slackStats(nullptr)
+{
+	counters.clear();
+	traceBuffer.setSource(&memorySource);
+	freePhysRegsPrevCycle.reserve(width);
+	reservationStations.push_back(new ReservationStation("ALU", RSType_ALU, 1));
+	reservationStations.push_back(new ReservationStation("ALU", RSType_ALU, 1));
+	reservationStations.push_back(new ReservationStation("LOAD", RSType_LOAD, 2));
+	reservationStations.push_back(new ReservationStation("STORE", RSType_STORE, 2));
+}
+
+template <class Observer>
+BasicCPU<Observer>::BasicCPU(uint32_t numArchRegs, uint32_t numPhysicalRegs,
+		uint32_t robEntries, uint32_t width, uint32_t numLSQEntries) :
+	BasicCPU(CPUConfig { numArchRegs, numPhysicalRegs, robEntries, width, numLSQEntries }) {
+}
+
+template <class Observer>
+BasicCPU<Observer>::~BasicCPU() {
+	for(ReservationStation* rs : reservationStations)
+		delete rs;
+}
+
+template <class Observer>
+void BasicCPU<Observer>::addInstruction(char type, uint32_t srcOp1,
+		uint32_t srcOp2, uint32_t dstOp) {
+	trace.addInstruction(type, srcOp1, srcOp2, dstOp);
+	// Fetch may have stopped at the old end of the trace. Restarting it
+	// breaks the pattern extrapolation relies on.
+	if(!isFetching && extrapolation)
+		steadyState.reset(numPhysicalRegs);
+	isFetching = true;
+}
+
+template <class Observer>
+void BasicCPU<Observer>::setTrace(const InstructionTrace& trace) {
+	if(cycle != 0) {
+		std::cerr << __func__ << " called after the simulation started\n";
+		assert(false);
+	}
+	this->trace = trace;
+	traceBuffer.setSource(&memorySource);
+	isFetching = traceBuffer.has(0);
+}
+
+template <class Observer>
+void BasicCPU<Observer>::setTraceSource(TraceSource* source, InstrNum firstInstruction) {
+	if(cycle != 0) {
+		std::cerr << __func__ << " called after the simulation started\n";
+		assert(false);
+	}
+	if(!traceBuffer.setSource(source ? source : &memorySource, firstInstruction))
+		std::cerr << "Cannot read the trace from the start\n";
+	isFetching = traceBuffer.has(0);
+}
+
+template <class Observer>
+bool BasicCPU<Observer>::isFinished() const {
+	// Instructions retire in order, so counting them is enough.
+	return !isFetching && numRetired == fetchPtr;
+}
+
+template <class Observer>
+void BasicCPU<Observer>::simulate() {
+	step(UINT64_MAX);
+}
+
+template <class Observer>
+Cycle BasicCPU<Observer>::step(Cycle numCycles) {
+	Cycle start = cycle;
+	while(cycle - start < numCycles && !isFinished() && hasProgress) {
+		// Interval records fall on simulated cycles.
+		if(extrapolation && extrapolate(std::min(numCycles - (cycle - start),
+				nextIntervalRecord - cycle - 1), UINT64_MAX))
+			continue;
+		hasProgress = false;
+		tick();
+		if(cycle >= nextReport)
+			report(false);
+	}
+	report(true);
+	return cycle - start;
+}
+
+template <class Observer>
+bool BasicCPU<Observer>::runUntil(InstrNum instrNumber) {
+	while(numRetired <= instrNumber && !isFinished() && hasProgress) {
+		if(extrapolation && extrapolate(nextIntervalRecord - cycle - 1, instrNumber))
+			continue;
+		hasProgress = false;
+		tick();
+		if(cycle >= nextReport)
+			report(false);
+	}
+	report(true);
+	return numRetired > instrNumber;
+}
+
+template <class Observer>
+void BasicCPU<Observer>::reset() {
+	reset(getConfig());
+}
+
+template <class Observer>
+void BasicCPU<Observer>::reset(const CPUConfig& config) {
+	numArchRegs = config.numArchRegs;
+	numPhysicalRegs = config.numPhysicalRegs;
+	robEntries = config.robEntries;
+	width = config.width;
+	numLSQEntries = config.numLSQEntries;
+	archMappingTable = MappingTable("archMapTable", numArchRegs, numPhysicalRegs);
+	mapTable = MappingTable("Mapping Table", numArchRegs, numPhysicalRegs);
+	rob = ReorderBuffer(robEntries);
+	freeList = FreeList(numArchRegs, numPhysicalRegs);
+	freePhysRegsPrevCycle.clear();
+	freePhysRegsPrevCycle.reserve(width);
+	fetchStage = PipelineStage("fetch", width);
+	decodeStage = InOrderStage("decode");
+	dispatchStage = InOrderStage("dispatch");
+	issueStage = PipelineStage("issue", width);
+	executeStage = PipelineStage("execute", width);
+	completeStage = PipelineStage("complete", width);
+	retireStage = PipelineStage("retire", width);
+	for(ReservationStation* rs : reservationStations)
+		rs->free();
+	history.clear();
+	instructionPool.reset();
+	if(!traceBuffer.rewind())
+		std::cerr << "Cannot read the trace from the start\n";
+	fetchPtr = 0;
+	numRetired = 0;
+	isFetching = traceBuffer.has(0);
+	hasProgress = true;
+	cycle = 0;
+	if(extrapolation)
+		steadyState.reset(numPhysicalRegs);
+	extrapolatedCycles = 0;
+	counters.clear();
+	if(statsPage)
+		nextStatsUpdate = statsInterval;
+	if(intervalLog) {
+		intervalLog->restart();
+		nextIntervalRecord = recordInterval;
+	}
+	nextReport = std::min(nextStatsUpdate, nextIntervalRecord);
+	stallHistory.clear();
+	decodeStalls.clear();
+	firstDecodeStalls = 0;
+	regProducer.assign(stallAttribution ? numPhysicalRegs : 0, INSTR_NONE);
+	lastCompleter = INSTR_NONE;
+	lastCompleteCycle = 0;
+	regReadyCycle.assign(registerHotSpots ? numPhysicalRegs : 0, 0);
+	windowDepth.assign(windowStats ? numPhysicalRegs : 0, 0);
+}
+
+template <class Observer>
+void BasicCPU<Observer>::setExtrapolation(bool enabled) {
+	if(enabled && !extrapolation)
+		steadyState.reset(numPhysicalRegs);
+	extrapolation = enabled;
+}
+
+template <class Observer>
+void BasicCPU<Observer>::setStallAttribution(bool enabled) {
+	if(cycle != 0) {
+		std::cerr << __func__ << " called after the simulation started\n";
+		assert(false);
+	}
+	stallAttribution = enabled;
+	regProducer.assign(enabled ? numPhysicalRegs : 0, INSTR_NONE);
+}
+
+template <class Observer>
+void BasicCPU<Observer>::setRegisterHotSpots(RegisterHotSpots* hotSpots) {
+	if(cycle != 0) {
+		std::cerr << __func__ << " called after the simulation started\n";
+		assert(false);
+	}
+	registerHotSpots = hotSpots;
+	regReadyCycle.assign(hotSpots ? numPhysicalRegs : 0, 0);
+}
+
+template <class Observer>
+void BasicCPU<Observer>::setWindowStats(WindowStats* stats) {
+	if(cycle != 0) {
+		std::cerr << __func__ << " called after the simulation started\n";
+		assert(false);
+	}
+	windowStats = stats;
+	windowDepth.assign(stats ? numPhysicalRegs : 0, 0);
+}
+
+template <class Observer>
+void BasicCPU<Observer>::setSlackStats(SlackStats* stats) {
+	if(cycle != 0) {
+		std::cerr << __func__ << " called after the simulation started\n";
+		assert(false);
+	}
+	slackStats = stats;
+}
+
+template <class Observer>
+void BasicCPU<Observer>::sampleWindow() {
+	uint32_t numReady = 0;
+	for(ReservationStation* rs : reservationStations)
+		if(rs->isReadyToExecute() && !rs->getInst()->hasIssued())
+			numReady++;
+	// A register read in the window is either written in it, by an older
+	// instruction, or holds a value from before it, so clearing the
+	// destinations first leaves every other source at depth 0. Completed
+	// instructions no longer hold anyone back.
+	uint32_t numEntries = rob.size();
+	for(uint32_t i = 0; i < numEntries; i++) {
+		uint32_t regNum = rob.at(i).getInst()->getDstPhysicalReg().getRegNum();
+		if(regNum != -1)
+			windowDepth[regNum] = 0;
+	}
+	uint32_t longest = 0;
+	for(uint32_t i = 0; i < numEntries; i++) {
+		Instruction* inst = rob.at(i).getInst();
+		if(inst->hasCompleted())
+			continue;
+		uint32_t depth = 0;
+		uint32_t regNum = inst->getSrcPhysicalReg1().getRegNum();
+		if(regNum != -1)
+			depth = windowDepth[regNum];
+		regNum = inst->getSrcPhysicalReg2().getRegNum();
+		if(regNum != -1)
+			depth = std::max(depth, windowDepth[regNum]);
+		depth++;
+		regNum = inst->getDstPhysicalReg().getRegNum();
+		if(regNum != -1)
+			windowDepth[regNum] = depth;
+		longest = std::max(longest, depth);
+	}
+	windowStats->add(numReady, longest, numEntries);
+}
+
+template <class Observer>
+void BasicCPU<Observer>::countRegisterWait(Instruction* inst) {
+	// Operands that became ready after dispatch were waited for; the
+	// register that was ready last held the instruction back. A source
+	// register keeps its value until the instruction retires, so its ready
+	// cycle is still that of the value read.
+	Cycle dispatchCycle = history.getStageCycle(inst->getInstrNumber(), Stage_DISPATCH);
+	Cycle latest = dispatchCycle;
+	uint32_t archReg = -1;
+	uint32_t regNum = inst->getSrcPhysicalReg1().getRegNum();
+	if(regNum != -1 && regReadyCycle[regNum] > latest) {
+		latest = regReadyCycle[regNum];
+		archReg = inst->getSrcOp1();
+	}
+	regNum = inst->getSrcPhysicalReg2().getRegNum();
+	if(regNum != -1 && regReadyCycle[regNum] > latest) {
+		latest = regReadyCycle[regNum];
+		archReg = inst->getSrcOp2();
+	}
+	if(archReg != -1)
+		registerHotSpots->addIssueWait(archReg, latest - dispatchCycle);
+}
+
+template <class Observer>
+void BasicCPU<Observer>::attributeDispatch(InstrNum instrNumber, const PhysicalRegister& T) {
+	while(decodeStalls.size() - firstDecodeStalls > 1 &&
+			decodeStalls[firstDecodeStalls + 1].firstInstr <= instrNumber)
+		firstDecodeStalls++;
+	StallRow row = { STALL_CODE_NONE, 0, INSTR_NONE, INSTR_NONE };
+	uint64_t most = 0;
+	for(int r = 0; r < StallReason_COUNT; r++) {
+		uint64_t numStalls = counters.stalls[r] - decodeStalls[firstDecodeStalls].stalls[r];
+		if(numStalls > most) {
+			most = numStalls;
+			row.dispatchStall = r + 1;
+		}
+	}
+	stallHistory.push_back(row);
+	if(T.getRegNum() != -1)
+		regProducer[T.getRegNum()] = instrNumber;
+}
+
+template <class Observer>
+void BasicCPU<Observer>::attributeIssue(Instruction* inst) {
+	StallRow& row = stallHistory[inst->getInstrNumber()];
+	// An operand was waited for if its producer completed after dispatch.
+	// The register cannot have been reused since: that takes the next
+	// writer of the same architectural register to retire.
+	Cycle latest = history.getStageCycle(inst->getInstrNumber(), Stage_DISPATCH);
+	PhysicalRegister* sources[2] = { &inst->getSrcPhysicalReg1(), &inst->getSrcPhysicalReg2() };
+	for(int k = 0; k < 2; k++) {
+		uint32_t regNum = sources[k]->getRegNum();
+		if(regNum == -1 || regProducer[regNum] == INSTR_NONE)
+			continue;
+		Cycle ready = history.getStageCycle(regProducer[regNum], Stage_COMPLETE);
+		if(ready > latest) {
+			latest = ready;
+			row.issueOperand = k + 1;
+			row.issueProducer = regProducer[regNum];
+		}
+	}
+}
+
+template <class Observer>
+void BasicCPU<Observer>::attributeRetire(Instruction* inst) {
+	InstrNum instrNumber = inst->getInstrNumber();
+	Cycle completeCycle = history.getStageCycle(instrNumber, Stage_COMPLETE);
+	if(lastCompleteCycle > completeCycle) {
+		stallHistory[instrNumber].retireBlocker = lastCompleter;
+	}
+	else {
+		lastCompleter = instrNumber;
+		lastCompleteCycle = completeCycle;
+	}
+}
+
+template <class Observer>
+void BasicCPU<Observer>::setStatsPage(StatsPage* page, Cycle interval) {
+	statsPage = page;
+	statsInterval = interval ? interval : 1;
+	nextStatsUpdate = page ? cycle + statsInterval : UINT64_MAX;
+	nextReport = std::min(nextStatsUpdate, nextIntervalRecord);
+}
+
+template <class Observer>
+void BasicCPU<Observer>::setIntervalLog(IntervalLog* log, Cycle interval) {
+	intervalLog = log;
+	recordInterval = interval ? interval : 1;
+	nextIntervalRecord = log ? cycle + recordInterval : UINT64_MAX;
+	nextReport = std::min(nextStatsUpdate, nextIntervalRecord);
+}
+
+template <class Observer>
+void BasicCPU<Observer>::report(bool returning) {
+	if(statsPage && (returning || cycle >= nextStatsUpdate))
+		updateStatsPage();
+	// The last interval ends with the simulation.
+	if(intervalLog && (cycle >= nextIntervalRecord ||
+			(returning && (isFinished() || !hasProgress)))) {
+		intervalLog->record(cycle, numRetired, counters, freeList.size());
+		nextIntervalRecord = cycle + recordInterval;
+	}
+	nextReport = std::min(nextStatsUpdate, nextIntervalRecord);
+}
+
+template <class Observer>
+void BasicCPU<Observer>::updateStatsPage() {
+	InstrNum instructions = traceBuffer.getSource()->size() != TRACE_SIZE_UNKNOWN ?
+			traceBuffer.getSize() : 0;
+	statsPage->update(cycle, numRetired, fetchPtr, instructions, rob.size(),
+			freeList.size(), isFinished());
+	if(statsPage->takeSnapshotRequest()) {
+		// Renamed into place so that readers never see half a snapshot.
+		std::string path = statsPage->getSnapshotPath();
+		std::ofstream out(path + ".tmp");
+		writeSnapshot(out);
+		out.close();
+		if(!out || rename((path + ".tmp").c_str(), path.c_str()) != 0)
+			std::cerr << "Cannot write " << path << "\n";
+	}
+	nextStatsUpdate = cycle + statsInterval;
+}
+
+template <class Observer>
+void BasicCPU<Observer>::writeSnapshot(std::ostream& out) {
+	InstrNum firstInDecode = fetchPtr - decodeStage.size();
+	out << "{\n";
+	out << "  \"cycle\": " << cycle << ",\n";
+	out << "  \"fetched\": " << fetchPtr << ",\n";
+	out << "  \"retired\": " << numRetired << ",\n";
+	out << "  \"fetching\": " << (isFetching ? "true" : "false") << ",\n";
+	out << "  \"decodeQueue\": [" << firstInDecode << ", " << fetchPtr << "],\n";
+	out << "  \"dispatchQueue\": [" << firstInDecode - dispatchStage.size() << ", " <<
+			firstInDecode << "],\n";
+	out << "  \"rob\": [";
+	for(uint32_t i = 0; i < rob.size(); i++) {
+		ROBEntry& entry = rob.at(i);
+		Instruction* inst = entry.getInst();
+		int stage = Stage_DISPATCH;
+		while(stage + 1 < Stage_COUNT && inst->hasReachedStage((TimingStage) (stage + 1)))
+			stage++;
+		out << (i ? ",\n" : "\n") << "    {\"instr\": " << inst->getInstrNumber() <<
+				", \"type\": \"" << inst->getType() << "\", \"stage\": \"" <<
+				getStageName((TimingStage) stage) << "\", \"T\": " <<
+				(int32_t) entry.getT().getRegNum() << ", \"Told\": " <<
+				(int32_t) entry.getTold().getRegNum() << "}";
+	}
+	out << "\n  ],\n";
+	out << "  \"reservationStations\": [";
+	for(size_t i = 0; i < reservationStations.size(); i++) {
+		ReservationStation* rs = reservationStations[i];
+		out << (i ? ",\n" : "\n") << "    {\"name\": \"" << rs->getName() << "\", \"instr\": ";
+		if(rs->isBusy())
+			out << rs->getInst()->getInstrNumber() << "}";
+		else
+			out << "null}";
+	}
+	out << "\n  ],\n";
+	out << "  \"executeQueue\": [";
+	for(uint32_t i = 0; i < executeStage.size(); i++)
+		out << (i ? ", " : "") << executeStage.at(i)->getInstrNumber();
+	out << "],\n";
+	out << "  \"completeQueue\": [";
+	for(uint32_t i = 0; i < completeStage.size(); i++)
+		out << (i ? ", " : "") << completeStage.at(i)->getInstrNumber();
+	out << "],\n";
+	out << "  \"mapTable\": [";
+	for(uint32_t i = 0; i < numArchRegs; i++) {
+		PhysicalRegister reg = mapTable.getMapping(i);
+		out << (i ? ", " : "") << "{\"phys\": " << reg.getRegNum() << ", \"ready\": " <<
+				(reg.isReady() ? "true" : "false") << "}";
+	}
+	out << "],\n";
+	out << "  \"freeList\": [";
+	for(uint32_t i = 0; i < freeList.size(); i++)
+		out << (i ? ", " : "") << freeList.at(i).getRegNum();
+	out << "]\n";
+	out << "}\n";
+}
+
+template <class Observer>
+CPUConfig BasicCPU<Observer>::getConfig() const {
+	CPUConfig config = { numArchRegs, numPhysicalRegs, robEntries, width, numLSQEntries };
+	return config;
+}
+
+template <class Observer>
+CPUStats BasicCPU<Observer>::getStats() const {
+	CPUStats stats;
+	stats.cycles = cycle;
+	stats.instructions = traceBuffer.getSize();
+	stats.fetched = fetchPtr;
+	stats.retired = numRetired;
+	stats.finished = isFinished();
+	stats.stuck = !stats.finished && !hasProgress;
+	stats.extrapolatedCycles = extrapolatedCycles;
+	return stats;
+}
+
+template <class Observer>
+void BasicCPU<Observer>::tick() {
+	// add physical registers that are freed in the previous cycle to freeList
+	for(PhysicalRegister& pReg : freePhysRegsPrevCycle)
+		freeList.addRegister(pReg);
+	counters.accesses.count(Access_FREE_LIST_PUSH, freePhysRegsPrevCycle.size());
+	freePhysRegsPrevCycle.clear();
+	// We process pipeline stages in opposite order to (try to) clear up
+	// the subsequent stage before sending instruction forward from any
+	// given stage.
+	retire();
+	complete();
+	execute();
+	// What issue gets to choose from.
+	if(windowStats)
+		sampleWindow();
+	issue();
+	dispatch();
+	decode();
+	fetch();
+	if(debugLog)
+		logState();
+	counters.robOccupancy += rob.size();
+	counters.freeRegisters += freeList.size();
+	// Move on to the next cycle.
+	cycle++;
+}
+
+template <class Observer>
+void BasicCPU<Observer>::logStage(const char* stage, const Instruction& inst) {
+	if(!debugLog)
+		return;
+	*debugLog << "Cycle #" << cycle << ": " << stage << "\t";
+	inst.print(*debugLog);
+	*debugLog << "\n";
+}
+
+template <class Observer>
+void BasicCPU<Observer>::logStage(const char* stage, InstrNum instrNumber) {
+	if(!debugLog)
+		return;
+	Instruction inst;
+	inst.init(instrNumber, traceBuffer[instrNumber]);
+	logStage(stage, inst);
+}
+
+template <class Observer>
+void BasicCPU<Observer>::logState() {
+	std::ostream& out = *debugLog;
+	rob.print(out);
+	out << "\n";
+	out << "Reservation Stations : [\n";
+	for(int i = 0; i < reservationStations.size(); i++) {
+		out << "\t";
+		reservationStations[i]->print(out);
+		out << "\n";
+	}
+	out << "]\n";
+	mapTable.print(out);
+	out << "\n";
+	archMappingTable.print(out);
+	out << "\n";
+	freeList.print(out);
+	out << "\n\n";
+}
+
+template <class Observer>
+void BasicCPU<Observer>::buildStateKey() {
+	// Everything the next cycles depend on, except the contents of the
+	// front end, which only matter once dispatch gets to them, and the
+	// architectural mapping table, which is never read.
+	InstrNum numWaiting = dispatchStage.size();
+	InstrNum nextToDispatch = fetchPtr - decodeStage.size() - numWaiting;
+	steadyState.beginKey();
+	// Dispatch takes at most width instructions a cycle, so with more
+	// waiting it does not matter how many.
+	steadyState.add(std::min(numWaiting, (InstrNum) width));
+	if(numWaiting < width) {
+		steadyState.add(isFetching);
+		steadyState.add(decodeStage.size());
+	}
+	for(uint32_t i = 0; i < numArchRegs; i++)
+		steadyState.addRegister(mapTable.getMapping(i), true);
+	steadyState.add(rob.size());
+	for(uint32_t i = 0; i < rob.size(); i++) {
+		ROBEntry& entry = rob.at(i);
+		Instruction* inst = entry.getInst();
+		steadyState.add(nextToDispatch - inst->getInstrNumber());
+		steadyState.add(inst->getType() | inst->getStagesReached() << 8 |
+				inst->getAllocatedRs() << 16 | (uint64_t) inst->getExecTime() << 32);
+		steadyState.add(inst->getSrcOp1() | (uint64_t) inst->getSrcOp2() << 32);
+		steadyState.add(inst->getDstOp());
+		steadyState.add(inst->hasReachedStage(Stage_EXECUTE) ?
+				cycle - inst->getExecuteCycle() : CYCLE_UNSET);
+		steadyState.addRegister(inst->getSrcPhysicalReg1(), true);
+		steadyState.addRegister(inst->getSrcPhysicalReg2(), true);
+		steadyState.addRegister(inst->getDstPhysicalReg(), true);
+		// Registers go back to the free list with their ready bit, but it
+		// is overwritten when they are handed out again.
+		steadyState.addRegister(entry.getT(), false);
+		steadyState.addRegister(entry.getTold(), false);
+	}
+	for(ReservationStation* rs : reservationStations)
+		steadyState.add(rs->isBusy() ? nextToDispatch - rs->getInst()->getInstrNumber() : UINT64_MAX);
+	steadyState.add(executeStage.size());
+	for(uint32_t i = 0; i < executeStage.size(); i++)
+		steadyState.add(nextToDispatch - executeStage.at(i)->getInstrNumber());
+	steadyState.add(completeStage.size());
+	for(uint32_t i = 0; i < completeStage.size(); i++)
+		steadyState.add(nextToDispatch - completeStage.at(i)->getInstrNumber());
+	steadyState.add(freePhysRegsPrevCycle.size());
+	for(PhysicalRegister& pReg : freePhysRegsPrevCycle)
+		steadyState.addRegister(pReg, false);
+	steadyState.add(freeList.size());
+	for(uint32_t i = 0; i < freeList.size(); i++)
+		steadyState.addRegister(freeList.at(i), false);
+}
+
+template <class Observer>
+InstrNum BasicCPU<Observer>::fetchedAfter(Cycle numCycles, InstrNum& numDecoded) {
+	// Fetch and decode never stall, so each cycle fetches width more
+	// instructions until the trace ends and decodes the previous ones.
+	numDecoded = fetchPtr;
+	if(!isFetching)
+		return fetchPtr;
+	InstrNum target = fetchPtr + numCycles * width;
+	InstrNum numFetched = traceBuffer.has(target - 1) ? target : traceBuffer.getNumRead();
+	numDecoded = std::min(numFetched, target - width);
+	return numFetched;
+}
+
+template <class Observer>
+bool BasicCPU<Observer>::extrapolate(Cycle maxCycles, InstrNum retireLimit) {
+	// Skipped instructions would have no stall attribution or latencies, and
+	// skipped cycles no window samples.
+	if(stallAttribution || latencyStats || registerHotSpots || windowStats || slackStats)
+		return false;
+	InstrNum numWaiting = dispatchStage.size();
+	// With fewer than width instructions waiting, dispatch depends on the
+	// front end, which only repeats while it fetches at full width.
+	if(numWaiting < width && (!isFetching || decodeStage.size() != width))
+		return false;
+	buildStateKey();
+	InstrNum firstInDecode = fetchPtr - decodeStage.size();
+	InstrNum nextToDispatch = firstInDecode - numWaiting;
+	SteadyStatePoint point = { cycle, nextToDispatch, numRetired, counters };
+	SteadyStatePoint previous;
+	if(!steadyState.endKey(point, previous))
+		return false;
+	// The same state one period ago: every period from here on takes
+	// periodCycles cycles if the trace keeps repeating every period
+	// instructions. Retire keeps up with dispatch, the RoB being as full
+	// as it was.
+	InstrNum period = nextToDispatch - previous.dispatched;
+	Cycle periodCycles = cycle - previous.cycle;
+	if(period == 0 || !steadyState.hasRecorded(previous.dispatched, period)) {
+		steadyState.restart(point);
+		return false;
+	}
+	InstrNum maxPeriods = std::min(maxCycles / periodCycles,
+			(retireLimit - numRetired) / period);
+	if(maxPeriods == 0)
+		return false;
+	InstrNum numPeriods = 0;
+	InstrNum numFetched = fetchPtr;
+	InstrNum numDecoded = firstInDecode;
+	for(; numPeriods < maxPeriods; numPeriods++) {
+		InstrNum first = nextToDispatch + numPeriods * period;
+		if(!traceBuffer.has(first + period - 1))
+			break;
+		bool repeats = true;
+		for(InstrNum i = 0; i < period && repeats; i++)
+			repeats = SteadyStateDetector::sameTiming(traceBuffer[first + i],
+					steadyState.getRecorded(previous.dispatched + i));
+		if(!repeats)
+			break;
+		// Dispatch must find as many instructions waiting as now at the
+		// end of the period, and, as the waiting instructions only go up
+		// while fetching and down afterwards, in between as well.
+		InstrNum decoded;
+		Cycle numCycles = (numPeriods + 1) * periodCycles;
+		InstrNum fetched = fetchedAfter(numCycles, decoded);
+		InstrNum dispatched = first + period;
+		if(numWaiting < width) {
+			if(fetched != fetchPtr + numCycles * width || !traceBuffer.has(fetched) ||
+					decoded != dispatched + numWaiting)
+				break;
+		}
+		else if(decoded < dispatched + width)
+			break;
+		numFetched = fetched;
+		numDecoded = decoded;
+	}
+	if(numPeriods == 0) {
+		steadyState.restart(point);
+		return false;
+	}
+
+	InstrNum numInstructions = numPeriods * period;
+	Cycle numCycles = numPeriods * periodCycles;
+	for(InstrNum i = firstInDecode; i < fetchPtr; i++)
+		history.setStageCycle(i, Stage_DECODE, cycle);
+	for(InstrNum i = fetchPtr; i < numFetched; i++) {
+		Cycle fetchCycle = cycle + (i - fetchPtr) / width;
+		history.addInstruction(fetchCycle);
+		if(i < numDecoded)
+			history.setStageCycle(i, Stage_DECODE, fetchCycle + 1);
+	}
+	// Each period of the back end repeats the one before, shifted by one
+	// period. Only instructions between the oldest in flight and the
+	// youngest dispatched had anything happen to them during a period.
+	for(InstrNum p = 0; p < numPeriods; p++) {
+		Cycle start = previous.cycle + p * periodCycles;
+		for(InstrNum i = previous.retired + p * period; i < nextToDispatch + p * period; i++) {
+			for(int s = Stage_DISPATCH; s < Stage_COUNT; s++) {
+				Cycle stageCycle = history.getStageCycle(i, (TimingStage) s);
+				if(stageCycle != CYCLE_UNSET && stageCycle >= start &&
+						stageCycle < start + periodCycles)
+					history.setStageCycle(i + period, (TimingStage) s, stageCycle + periodCycles);
+			}
+		}
+	}
+	// The instructions in flight become their counterparts numPeriods
+	// periods later; their physical registers can stay, as nothing but
+	// their identity matters.
+	for(uint32_t i = 0; i < rob.size(); i++) {
+		Instruction* inst = rob.at(i).getInst();
+		inst->setInstrNumber(inst->getInstrNumber() + numInstructions);
+		if(inst->hasReachedStage(Stage_EXECUTE))
+			inst->setExecuteCycle(inst->getExecuteCycle() + numCycles);
+	}
+	for(InstrNum i = 0; i < numInstructions; i++)
+		traceBuffer.pop();
+	decodeStage.advance(numDecoded - firstInDecode, numFetched - fetchPtr);
+	dispatchStage.advance(numInstructions, numDecoded - firstInDecode);
+	isFetching = isFetching && numFetched == fetchPtr + numCycles * width &&
+			traceBuffer.has(numFetched);
+	fetchPtr = numFetched;
+	numRetired += numInstructions;
+	cycle += numCycles;
+	extrapolatedCycles += numCycles;
+	// Every period counts the same as the last one.
+	PipelineCounters skipped = counters;
+	skipped.subtract(previous.counters);
+	skipped.multiply(numPeriods);
+	counters.add(skipped);
+	steadyState.shiftReference(numInstructions, numCycles, skipped);
+	hasProgress = true;
+	return true;
+}
+
+template <class Observer>
+void BasicCPU<Observer>::enterStage(Instruction* inst, TimingStage stage) {
+	inst->markStageReached(stage);
+	history.setStageCycle(inst->getInstrNumber(), stage, cycle);
+}
+
+template <class Observer>
+void BasicCPU<Observer>::fetch() {
+	// Timing history grows with every fetch, and the stall history and
+	// slack stats with every dispatch and retire; size them once for the
+	// whole trace if the source knows its length.
+	if(traceBuffer.getSource()->size() != TRACE_SIZE_UNKNOWN) {
+		InstrNum size = traceBuffer.getSize();
+		history.reserve(size);
+		if(stallAttribution)
+			stallHistory.reserve(size);
+		if(slackStats)
+			slackStats->reserve(size);
+	}
+	for(int i = 0; i < width && isFetching; i++) {
+		// hasProgress should set if CPU has progress in any stage at each cycle
+		if(!traceBuffer.has(fetchPtr)) {
+			isFetching = false;
+			break;
+		}
+		// The decode queue is unbounded, fetch never stalls in this project
+		decodeStage.push(fetchPtr);
+		hasProgress = true;
+		logStage("fetch   ", fetchPtr);
+		observer.onFetch(cycle, fetchPtr);
+		R10K_PROBE2(fetch, fetchPtr, cycle);
+		history.addInstruction(cycle);
+		fetchPtr++;
+		if(!traceBuffer.has(fetchPtr)) {
+			isFetching = false;
+		}
+	}
+}
+
+template <class Observer>
+void BasicCPU<Observer>::decode() {
+	for(int i = 0; i < width; i++) {
+		if(decodeStage.isEmpty())
+			break;
+		InstrNum instrNumber = decodeStage.front();
+		if(stallAttribution && i == 0) {
+			DecodeStalls entry;
+			entry.firstInstr = instrNumber;
+			std::copy_n(counters.stalls, StallReason_COUNT, entry.stalls);
+			if(decodeStalls.size() == decodeStalls.capacity() &&
+					firstDecodeStalls >= decodeStalls.size() / 2) {
+				decodeStalls.erase(decodeStalls.begin(), decodeStalls.begin() + firstDecodeStalls);
+				firstDecodeStalls = 0;
+			}
+			decodeStalls.push_back(entry);
+		}
+		// The dispatch queue is unbounded, so decode never stalls either
+		dispatchStage.push(instrNumber);
+		history.setStageCycle(instrNumber, Stage_DECODE, cycle);
+		logStage("decode  ", instrNumber);
+		observer.onDecode(cycle, instrNumber);
+		hasProgress = true;
+		decodeStage.pop();
+	}
+}
+
+template <class Observer>
+void BasicCPU<Observer>::dispatch() {
+	for(int i = 0; i < width; i++) {
+		if(dispatchStage.isEmpty())
+			break;
+		// No free RoB Entry -> stall
+		if(!rob.hasFreeEntry()) {
+			observer.onStall(cycle, dispatchStage.front(), StallReason_ROB_FULL);
+			counters.stalls[StallReason_ROB_FULL]++;
+			R10K_PROBE2(stall_rob_full, dispatchStage.front(), cycle);
+			break;
+		}
+
+		InstrNum instrNumber = dispatchStage.front();
+		const StaticInstruction& staticInst = traceBuffer[instrNumber];
+
+		// Check if corresponding RS is free
+		RSType requiredType = staticInst.getReservationStation();
+		uint32_t freeRSIndex = -1;
+		for(int j = 0; j < reservationStations.size(); j++) {
+			if(reservationStations[j]->getType() == requiredType &&
+					reservationStations[j]->isBusy() == false) {
+				freeRSIndex = j;
+				break;
+			}
+		}
+		// required RS is busy -> stall
+		if(freeRSIndex == -1) {
+			observer.onStall(cycle, instrNumber, StallReason_RS_BUSY);
+			counters.stalls[StallReason_RS_BUSY]++;
+			R10K_PROBE3(stall_rs_busy, instrNumber, cycle, (int32_t) requiredType);
+			break;
+		}
+
+		// Renaming
+
+		// No free register in the free list -> stall
+		if(staticInst.dstOp != -1 && freeList.hasRegister() == false) {
+			observer.onStall(cycle, instrNumber, StallReason_FREE_LIST_EMPTY);
+			counters.stalls[StallReason_FREE_LIST_EMPTY]++;
+			if(registerHotSpots)
+				registerHotSpots->addFreeListStall(staticInst.dstOp);
+			R10K_PROBE3(stall_free_list_empty, instrNumber, cycle, (int32_t) staticInst.dstOp);
+			break;
+		}
+		// Every RoB entry owns at most one record, so the pool never grows
+		Instruction* inst = instructionPool.allocate();
+		inst->init(instrNumber, staticInst);
+		Instruction beforeRenaming = *inst;
+		inst->setSrcPhysicalReg1(mapTable.getMapping(inst->getSrcOp1()));
+		counters.accesses.count(Access_MAP_TABLE_READ);
+		if(inst->getSrcOp2() != -1) {
+			inst->setSrcPhysicalReg2(mapTable.getMapping(inst->getSrcOp2()));
+			counters.accesses.count(Access_MAP_TABLE_READ);
+		}
+		PhysicalRegister T;		// By default, T = -1
+		PhysicalRegister Told;	// By default, Told = -1
+		if(inst->getDstOp() != -1) {
+			T = freeList.popRegister();
+			T.setReady(false);
+			inst->setDstPhysicalReg(T);
+			Told = mapTable.getMapping(inst->getDstOp());
+			mapTable.setMapping(inst->getDstOp(), T);
+			counters.accesses.count(Access_FREE_LIST_POP);
+			counters.accesses.count(Access_MAP_TABLE_READ);
+			counters.accesses.count(Access_MAP_TABLE_WRITE);
+		}
+		else {
+			inst->setDstPhysicalReg(T);
+		}
+		inst->setRenamed(true);
+
+		// Add instruction to ROB
+		rob.addInstruction(inst, T, Told);
+		counters.accesses.count(Access_ROB_WRITE);
+
+		// Add instruction to Reservation Station
+		reservationStations[freeRSIndex]->allocate(inst);
+		counters.accesses.count(Access_RS_WRITE);
+		// Instruction need the reservation as well to free it at execute stage
+		inst->setAllocatedRs(freeRSIndex);
+
+		enterStage(inst, Stage_DISPATCH);
+		if(debugLog) {
+			*debugLog << "Cycle #" << cycle << ": dispatch\t";
+			beforeRenaming.print(*debugLog);
+			*debugLog << " ->\t";
+			inst->print(*debugLog);
+			*debugLog << "\n";
+		}
+		observer.onDispatch(cycle, *inst, T, Told);
+		if(stallAttribution)
+			attributeDispatch(instrNumber, T);
+		R10K_PROBE6(dispatch, instrNumber, cycle, (int32_t) T.getRegNum(),
+				(int32_t) Told.getRegNum(), (int32_t) inst->getSrcPhysicalReg1().getRegNum(),
+				(int32_t) inst->getSrcPhysicalReg2().getRegNum());
+		hasProgress = true;
+		if(extrapolation)
+			steadyState.recordDispatch(instrNumber, staticInst);
+		dispatchStage.pop();
+		traceBuffer.pop();
+	}
+}
+
+template <class Observer>
+void BasicCPU<Observer>::issue() {
+	// TODO Your code here
+	// Going over all reservation stations and execute the ones that are ready
+	// setIssueCycle for the instruction that is issued
+	// Uncomment and use the following two lines at the location which you issue an instruction
+	// std::cerr << "Cycle #" << cycle << ": issue   \t" << [inst]->toString() << "\n";	// [inst] may need to be changed
+	// hasProgress = true;
+
+	/*
+	Steps:
+
+	1. Go over the "width" to issue "width" number of instructions
+	2. Go over all reservation station entries
+	3. Before pushing it to execute stage, check isReadyToExecute() and
+       make sure the insruction has not been issued (i.e, hasIssued() returns false)
+	4. If isReadyToExecute(), push the instruction to execute stage queue
+	5. setIssueCycle for the instruction
+
+
+	*/
+    int width_counter = 0;
+	for (int i = 0; i < width; i++){
+        for(int j = 0; j < reservationStations.size(); j++){
+
+            Instruction* inst = reservationStations[j]->getInst();
+            if(reservationStations[j]->isReadyToExecute() && !(inst->hasIssued())){
+				// counts the number of times an instruction is issued.
+				// Cannot exceed "width" number of issues
+                width_counter += 1;
+                if(width_counter > width){
+                    return;
+                }
+				// push to execute stage
+                bool res = executeStage.push(inst);
+
+				// res is always true
+                if(res){
+                    enterStage(inst, Stage_ISSUE);
+                    logStage("issue   ", *inst);	// [inst] may need to be changed
+                    observer.onIssue(cycle, *inst);
+                    if(stallAttribution)
+                        attributeIssue(inst);
+                    if(registerHotSpots)
+                        countRegisterWait(inst);
+                    R10K_PROBE4(issue, inst->getInstrNumber(), cycle,
+                            (int32_t) inst->getSrcPhysicalReg1().getRegNum(),
+                            (int32_t) inst->getSrcPhysicalReg2().getRegNum());
+                    hasProgress = true;
+                }
+            }
+
+        }
+
+	}
+
+}
+
+template <class Observer>
+void BasicCPU<Observer>::execute() {
+	// TODO Your code here
+	// setExecuteCycle for the instruction that is started its execution
+	// setExecTime of the instruction according to the execution time of RS
+	// Free the reservation stations that are executed
+	// add executing instructions to completeStage
+	// Uncomment and use the following two lines at the location which you execute an instruction
+	// std::cerr << "Cycle #" << cycle << ": execute \t" << [inst]->toString() << "\n"; // [inst] may need to be changed
+	// hasProgress = true;
+
+	/*
+
+	Steps:
+	1. Go over the "width" to execute "width" number of instructions
+	2. Check if executeState isEmpty()
+    3. Extract the first instruction from the queue
+    4. Push it to complete stage queue (Do not check its completion here)
+    5. setExecuteCycle for instruction that started its execution
+    6. setExecTime from Reservation station execTime
+	*/
+	for (int i = 0; i < width; i++){
+        if(executeStage.isEmpty())
+            break;
+
+        Instruction* inst = executeStage.front();
+		// push to complete stage
+        bool res = completeStage.push(inst);
+
+        if(res){
+			// temp cariable to hold reservation station index
+			uint32_t RSIndex = -1;
+            RSType myType = inst->getReservationStation();
+            inst->setExecuteCycle(cycle);
+            enterStage(inst, Stage_EXECUTE);
+			
+			// find the reservation station index of this instruction based on the type
+            for(int j = 0; j < reservationStations.size(); j++) {
+                if(reservationStations[j]->getType() == myType){
+                    RSIndex = j;
+                    break;
+                }
+            }
+            inst->setExecTime(reservationStations[RSIndex]->getExecTime());
+            reservationStations[inst->getAllocatedRs()]->free();
+            counters.accesses.count((AccessType) (Access_FU_ALU + myType));
+            logStage("execute ", *inst); // [inst] may need to be changed
+            observer.onExecute(cycle, *inst);
+            hasProgress = true;
+			// pop from execute stage
+            executeStage.pop();
+        }
+    }
+}
+
+template <class Observer>
+void BasicCPU<Observer>::complete() {
+	// TODO Your code here
+	// setCompleteCycle for the instruction that is completed
+	// add instructions to completeStage that finished their execution time and current cycle
+	// set ready bit of the destination register
+	// broadcast the result to mapping table and reservation stations
+	// Uncomment and use the following two lines at the location which you execute an instruction
+	// std::cerr << "Cycle #" << cycle << ": complete\t" << [inst]->toString() << "\n"; // [inst] may need to be changed
+	// hasProgress = true;
+
+    for (int i = 0; i < width; i++){
+		
+    if(completeStage.isEmpty()){
+        break;
+
+    }
+
+    // go over the complete instruction queue
+    for(uint32_t j = 0; j < completeStage.size(); j++){
+        Instruction* inst = completeStage.at(j);
+		// get the executionTime and executionCycle 
+		Cycle executionCycle = inst->getExecuteCycle();
+        uint32_t executionTime = inst->getExecTime();
+        
+
+		// if current cycle + execution cycle 
+        if(cycle >= executionCycle + executionTime){
+            // Begin Complete
+
+            PhysicalRegister& destinationRegister = inst->getDstPhysicalReg();
+            uint32_t destinationRegNum = destinationRegister.getRegNum();
+			
+			// Broadcast
+			for (int z = 0; z < reservationStations.size(); z++){
+            //if(inst->getDstOp() != -1){
+                reservationStations[z]->broadcastRegReady(destinationRegNum);
+            //}
+			}
+			// Each station compares the tag with both operands.
+			counters.accesses.count(Access_WAKEUP_BROADCAST);
+			counters.accesses.count(Access_WAKEUP_COMPARE, 2 * reservationStations.size());
+		
+            // Update Mapping Table
+			// Check for Store instruction
+            if(inst->getDstOp() != -1) {
+                mapTable.setReadyBit(destinationRegNum);
+                counters.accesses.count(Access_MAP_TABLE_WRITE);
+                if(registerHotSpots)
+                    regReadyCycle[destinationRegNum] = cycle;
+
+            }
+
+        
+
+        // set complete cycle
+        enterStage(inst, Stage_COMPLETE);
+        counters.accesses.count(Access_ROB_WRITE);
+		
+		// Erase completed instrcution from complete queue
+        completeStage.erase(j);
+		
+        logStage("complete", *inst); // [inst] may need to be changed
+        observer.onComplete(cycle, *inst);
+        R10K_PROBE3(complete, inst->getInstrNumber(), cycle, (int32_t) destinationRegNum);
+        hasProgress = true;
+
+
+        }
+        else{
+            hasProgress = true;
+			}
+
+
+
+		}
+
+	}
+
+}
+
+template <class Observer>
+void BasicCPU<Observer>::retire() {
+	// TODO Your code here
+	// retire instructions from head of rob
+	// setRetireCycle for the instruction that is retired
+	// update freePhysRegsPrevCycle array that add the physical registers in current cycle to the free list in the beginning of next cycle
+	// update architectural mapping table
+	// Uncomment and use the following two lines at the location which you execute an instruction
+	// std::cerr << "Cycle #" << cycle << ": retire  \t" << [inst]->toString() << "\n"; // [inst] may need to be changed
+	// hasProgress = true;
+
+	/*
+
+    Steps:
+    1. Loop over "width" to retire "width" number of instructions
+    2. Get head entry
+    3. Get the head instruction from this ROB entry
+    4. Check if this instruction hasCompleted() ??
+    5. If completed, retire it
+    6. Push_back the renamed destination physical register of this instruction to deque "freePhysRegsPrevCycle"
+    7. Get the new destination register - getT() - PR#
+    8. Get the old destination register - getTold() - PR# (We need AR#)
+    9. Get the regNums of the two registers:
+        a. Get the instruction's type
+        b. Get dstOp
+        b. If it is store, get srcOp2
+    10. Update arch map table by archMapTable[Told_archRegNum] = T
+    11. set getRetired() to true
+	*/
+
+	for(int i=0; i < width; i++){
+        // Initial sanity check
+        if(rob.getHead() == nullptr){
+            break;
+        }
+
+        // This is the actual condition:
+        // We enter reture only if the head rob entry is completed
+        if(!(rob.getHead()->getInst()->hasCompleted())){
+            break;
+        }
+
+        ROBEntry* robHead = rob.getHead();
+        Instruction* inst = robHead->getInst();
+
+        // retire head
+        rob.retireHeadInstruction();
+        counters.accesses.count(Access_ROB_READ);
+
+        // get T and Told Physical Registers
+        PhysicalRegister& destinationReg = inst->getDstPhysicalReg();
+		
+        
+	// Update Arch Map Table
+        // check if destination register is not equal to -1 (Store)
+	
+        if(inst->getDstOp() != -1){
+            uint32_t destinationArchNum = inst->getDstOp();
+
+            archMappingTable.setMapping(destinationArchNum, destinationReg);
+            counters.accesses.count(Access_ARCH_MAP_TABLE_WRITE);
+
+        }
+		
+		PhysicalRegister destinationTold = robHead->getTold();
+        // Push the freed register to this temp buffer
+        if(inst->getDstOp() != -1){
+            freePhysRegsPrevCycle.push_back(destinationTold);
+        }
+
+        
+		// retire cycle
+        enterStage(inst, Stage_RETIRE);
+        numRetired++;
+
+        logStage("retire  ", *inst); // [inst] may need to be changed
+        observer.onRetire(cycle, *inst);
+        if(stallAttribution)
+            attributeRetire(inst);
+        if(latencyStats) {
+            TimingRow row;
+            history.getRow(inst->getInstrNumber(), row);
+            latencyStats->add(inst->getInstrNumber(), inst->getType(), row);
+        }
+        if(slackStats) {
+            TimingRow row;
+            history.getRow(inst->getInstrNumber(), row);
+            slackStats->add(inst->getType(), inst->getSrcOp1(), inst->getSrcOp2(), inst->getDstOp(),
+                    inst->getAllocatedRs(), row);
+        }
+        R10K_PROBE4(retire, inst->getInstrNumber(), cycle,
+                (int32_t) destinationReg.getRegNum(), (int32_t) destinationTold.getRegNum());
+        // The record is not referenced anywhere once it leaves the RoB
+        instructionPool.release(inst);
+	    hasProgress = true;
+
+
+
+    }
+
+}
+
+
+
+
+
+
+template <class Observer>
+void BasicCPU<Observer>::collectTimings(TimingFile& timings) {
+	TimingFileHeader header;
+	header.numArchRegs = numArchRegs;
+	header.numPhysicalRegs = numPhysicalRegs;
+	header.robEntries = robEntries;
+	header.width = width;
+	header.numLSQEntries = numLSQEntries;
+	header.traceHash = traceBuffer.getHash();
+	timings.setHeader(header);
+
+	std::vector<TimingRow>& rows = timings.getRows();
+	InstrNum numInstructions = traceBuffer.getSize();
+	rows.resize(numInstructions);
+	// Instructions that were never fetched have no history entry and
+	// report every stage as unset.
+	for(InstrNum i = 0; i < numInstructions; i++)
+		history.getRow(i, rows[i]);
+	std::vector<StallRow>& stallRows = timings.getStallRows();
+	stallRows.clear();
+	if(stallAttribution) {
+		StallRow none = { STALL_CODE_NONE, 0, INSTR_NONE, INSTR_NONE };
+		stallRows.assign(numInstructions, none);
+		std::copy_n(stallHistory.begin(), std::min<InstrNum>(stallHistory.size(), numInstructions),
+				stallRows.begin());
+	}
+}
+
+template <class Observer>
+void BasicCPU<Observer>::generateOutputFile(std::string outputFile) {
+	TimingFile timings;
+	collectTimings(timings);
+	if(!timings.saveText(outputFile))
+		exit(-1);
+}
+
+template <class Observer>
+void BasicCPU<Observer>::generateBinaryOutputFile(std::string outputFile) {
+	TimingFile timings;
+	collectTimings(timings);
+	if(!timings.saveBinary(outputFile))
+		exit(-1);
+}
+
+template <class Observer>
+std::string  BasicCPU<Observer>::toString() {
+	std::stringstream str;
+	str << "[OoO CPU cycle=" << cycle << "\n";
+	return str.str();
+}
+
+#endif /* SRC_CPU_IMPL_H_ */
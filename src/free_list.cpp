@@ -1,13 +1,14 @@
 #include "free_list.h"
 
 FreeList::FreeList(uint32_t numArchRegs, uint32_t numPhysicalRegs) :
-	numPhysicalRegs(numPhysicalRegs) {
+	numPhysicalRegs(numPhysicalRegs), head(0), count(0) {
 	name = __func__;
+	freeListMap.resize(numPhysicalRegs);
 	for(int i = numArchRegs; i < numPhysicalRegs; i++) {
 		PhysicalRegister physicalReg;
 		physicalReg.setRegNum(i);
 		physicalReg.setReady(true);
-		freeListMap.push_back(physicalReg);
+		addRegister(physicalReg);
 	}
 }
 
@@ -15,16 +16,17 @@ FreeList::~FreeList() {
 }
 
 bool FreeList::hasRegister() {
-	return freeListMap.size();
+	return count;
 }
 
 PhysicalRegister FreeList::popRegister() {
-	if(freeListMap.empty()) {
+	if(count == 0) {
 		std::cerr << name << " " << __func__ << " pop from empty free list\n";
 		assert(false);
 	}
-	PhysicalRegister regNum = freeListMap.front();
-	freeListMap.pop_front();
+	PhysicalRegister regNum = freeListMap[head];
+	head = (head + 1) % numPhysicalRegs;
+	count--;
 	return regNum;
 }
 
@@ -33,15 +35,25 @@ void FreeList::addRegister(PhysicalRegister& physicalRegNum) {
 		std::cerr << name << " " << __func__ << " invalid physicalRegNum : " << physicalRegNum.getRegNum() << "\n";
 		assert(false);
 	}
-	freeListMap.push_back(physicalRegNum);
+	if(count == numPhysicalRegs) {
+		std::cerr << name << " " << __func__ << " add to full free list\n";
+		assert(false);
+	}
+	freeListMap[(head + count) % numPhysicalRegs] = physicalRegNum;
+	count++;
+}
+
+void FreeList::print(std::ostream& out) const {
+	out << "[" << name << " ";
+	for(uint32_t i = 0; i < count; i++) {
+		freeListMap[(head + i) % numPhysicalRegs].print(out);
+		out << " ";
+	}
+	out << "]";
 }
 
 std::string FreeList::toString() {
 	std::stringstream str;
-	str << "[" << name << " ";
-	for(int i = 0; i < freeListMap.size(); i++) {
-		str << freeListMap[i].toString() << " ";
-	}
-	str << "]";
+	print(str);
 	return str.str();
 }
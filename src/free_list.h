@@ -1,15 +1,19 @@
 #ifndef SRC_FREE_LIST_H_
 #define SRC_FREE_LIST_H_
 
-#include <deque>
+#include <vector>
 
 #include "physical_register.h"
 #include "utils.h"
 
+// FIFO of free physical registers. A ring buffer sized to every physical
+// register, which bounds its contents, so it never allocates after setup.
 class FreeList {
 	std::string name;
 	uint32_t numPhysicalRegs;
-	std::deque<PhysicalRegister> freeListMap;
+	std::vector<PhysicalRegister> freeListMap;
+	uint32_t head;
+	uint32_t count;
 public:
 	FreeList(uint32_t numArchRegs, uint32_t numPhysicalRegs);
 	virtual ~FreeList();
@@ -18,6 +22,16 @@ public:
 	PhysicalRegister popRegister();
 	void addRegister(PhysicalRegister& physicalReg);
 
+	uint32_t size() const {
+		return count;
+	}
+
+	// i-th register popRegister() would hand out.
+	const PhysicalRegister& at(uint32_t i) const {
+		return freeListMap[(head + i) % numPhysicalRegs];
+	}
+
+	void print(std::ostream& out) const;
 	std::string toString();
 };
 
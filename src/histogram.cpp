@@ -0,0 +1,87 @@
+#include "histogram.h"
+
+#include <algorithm>
+#include <iomanip>
+
+Histogram::Histogram() {
+	clear();
+}
+
+void Histogram::clear() {
+	for(int i = 0; i < HISTOGRAM_BUCKETS; i++)
+		buckets[i] = 0;
+	count = 0;
+	sum = 0;
+	min = UINT64_MAX;
+	max = 0;
+}
+
+int Histogram::getBucket(uint64_t value) {
+	if(value < HISTOGRAM_EXACT)
+		return value;
+	int exponent = 63 - __builtin_clzll(value);
+	int sub = (value >> (exponent - 2)) & (HISTOGRAM_SUB_BUCKETS - 1);
+	return HISTOGRAM_EXACT + (exponent - 4) * HISTOGRAM_SUB_BUCKETS + sub;
+}
+
+uint64_t Histogram::getBucketStart(int bucket) {
+	if(bucket < HISTOGRAM_EXACT)
+		return bucket;
+	int exponent = 4 + (bucket - HISTOGRAM_EXACT) / HISTOGRAM_SUB_BUCKETS;
+	int sub = (bucket - HISTOGRAM_EXACT) % HISTOGRAM_SUB_BUCKETS;
+	return (uint64_t) (HISTOGRAM_SUB_BUCKETS + sub) << (exponent - 2);
+}
+
+void Histogram::add(uint64_t value, uint64_t times) {
+	if(times == 0)
+		return;
+	buckets[getBucket(value)] += times;
+	count += times;
+	sum += (double) value * times;
+	min = std::min(min, value);
+	max = std::max(max, value);
+}
+
+void Histogram::merge(const Histogram& other) {
+	for(int i = 0; i < HISTOGRAM_BUCKETS; i++)
+		buckets[i] += other.buckets[i];
+	count += other.count;
+	sum += other.sum;
+	min = std::min(min, other.min);
+	max = std::max(max, other.max);
+}
+
+uint64_t Histogram::getPercentile(double fraction) const {
+	if(count == 0)
+		return 0;
+	uint64_t rank = (uint64_t) (fraction * count);
+	if(rank == 0)
+		rank = 1;
+	uint64_t seen = 0;
+	for(int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		seen += buckets[i];
+		if(seen >= rank)
+			return std::max(getBucketStart(i), min);
+	}
+	return max;
+}
+
+void Histogram::write(std::ostream& out, const char* indent) const {
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	out << std::fixed << std::setprecision(1);
+	for(int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		if(buckets[i] == 0)
+			continue;
+		uint64_t start = getBucketStart(i);
+		uint64_t end = i + 1 < HISTOGRAM_BUCKETS ? getBucketStart(i + 1) - 1 : UINT64_MAX;
+		out << indent << std::setw(8) << start;
+		if(end != start)
+			out << "-" << std::left << std::setw(8) << end << std::right;
+		else
+			out << std::setw(9) << "";
+		out << std::setw(12) << buckets[i] << std::setw(7) << 100.0 * buckets[i] / count << "%\n";
+	}
+	out.flags(flags);
+	out.precision(precision);
+}
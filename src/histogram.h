@@ -0,0 +1,61 @@
+#ifndef SRC_HISTOGRAM_H_
+#define SRC_HISTOGRAM_H_
+
+#include <ostream>
+
+#include "utils.h"
+
+// Values below this have a bucket each; above, every power of two is
+// split into HISTOGRAM_SUB_BUCKETS buckets.
+#define HISTOGRAM_EXACT 16
+#define HISTOGRAM_SUB_BUCKETS 4
+#define HISTOGRAM_BUCKETS (HISTOGRAM_EXACT + (64 - 4) * HISTOGRAM_SUB_BUCKETS)
+
+/*
+ * Distribution of unsigned values, such as latencies in cycles, in
+ * log-linear buckets: exact for small values, within 25% above. Fixed
+ * size, so adding never allocates. Count, mean, minimum and maximum are
+ * exact; percentiles are the lower bound of their bucket.
+ */
+class Histogram {
+	uint64_t buckets[HISTOGRAM_BUCKETS];
+	uint64_t count;
+	// As a double, since sums of large values could overflow.
+	double sum;
+	uint64_t min;
+	uint64_t max;
+
+	static int getBucket(uint64_t value);
+	static uint64_t getBucketStart(int bucket);
+public:
+	Histogram();
+
+	void clear();
+	void add(uint64_t value, uint64_t times = 1);
+	void merge(const Histogram& other);
+
+	uint64_t getCount() const {
+		return count;
+	}
+
+	double getMean() const {
+		return count ? sum / count : 0;
+	}
+
+	uint64_t getMin() const {
+		return count ? min : 0;
+	}
+
+	uint64_t getMax() const {
+		return max;
+	}
+
+	// Smallest value with at least fraction of the values at or below it,
+	// rounded down to its bucket.
+	uint64_t getPercentile(double fraction) const;
+
+	// One line per non-empty bucket: its range, count and share.
+	void write(std::ostream& out, const char* indent = "") const;
+};
+
+#endif /* SRC_HISTOGRAM_H_ */
@@ -0,0 +1,33 @@
+#include "input_file.h"
+#include <fstream>
+
+bool readInputFile(std::string path, CPUConfig& config, InstructionTrace& trace) {
+	std::ifstream in(path);
+	if(!in.is_open()) {
+		std::cerr << "Cannot open input file " << path << "\n";
+		return false;
+	}
+	return readInputFile(in, config, trace);
+}
+
+bool readInputFile(std::istream& in, CPUConfig& config, InstructionTrace& trace) {
+	if(!(in >> config.numArchRegs >> config.numPhysicalRegs >> config.robEntries >>
+			config.width >> config.numLSQEntries)) {
+		std::cerr << "Input file has no configuration line\n";
+		return false;
+	}
+	char instType;
+	uint32_t instSrcOp1, instSrcOp2, instDstOp;
+	while(in >> instType) {
+		if(!(in >> instSrcOp1 >> instSrcOp2 >> instDstOp)) {
+			std::cerr << "Truncated instruction " << trace.size() << " in input file\n";
+			return false;
+		}
+		if(!StaticInstruction::isValidType(instType)) {
+			std::cerr << "Unsupported type " << instType << " of instruction " << trace.size() << "\n";
+			return false;
+		}
+		trace.addInstruction(instType, instSrcOp1, instSrcOp2, instDstOp);
+	}
+	return true;
+}
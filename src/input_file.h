@@ -0,0 +1,14 @@
+#ifndef SRC_INPUT_FILE_H_
+#define SRC_INPUT_FILE_H_
+
+#include <string>
+
+#include "cpu_config.h"
+#include "instruction_trace.h"
+
+// Reads an input file such as inputs/ex1.txt: the configuration line
+// followed by one "type srcOp1 srcOp2 dstOp" instruction per line.
+bool readInputFile(std::string path, CPUConfig& config, InstructionTrace& trace);
+bool readInputFile(std::istream& in, CPUConfig& config, InstructionTrace& trace);
+
+#endif /* SRC_INPUT_FILE_H_ */
@@ -1,49 +1,20 @@
 #include "instruction.h"
-#include "reservation_station.h"
 #include <sstream>
 
-Instruction::Instruction(uint32_t instrNumber, char type,
-		uint32_t srcOp1, uint32_t srcOp2, uint32_t dstOp) :
-		instrNumber(instrNumber), type(type), renamed(false),
-		allocatedRS(nullptr),
-		fetchCycle(-1), decodeCycle(-1), dispatchCycle(-1),
-		issueCycle(-1), executeCycle(-1), completeCycle(-1),
-		retireCycle(-1), execTime(-1) {
-	switch(type) {
-	case InstrType_REG:
-		this->srcOp1 = srcOp1;
-		this->srcOp2 = srcOp2;
-		this->immediate = -1;
-		this->dstOp = dstOp;
-		this->memAccess = false;
-		break;
-	case InstrType_IMM:
-		this->srcOp1 = srcOp1;
-		this->srcOp2 = -1;
-		this->immediate = srcOp2;
-		this->dstOp = dstOp;
-		this->memAccess = false;
-		break;
-	case InstrType_LOAD:
-		this->srcOp1 = srcOp1;
-		this->srcOp2 = -1;
-		this->immediate = srcOp2;
-		this->dstOp = dstOp;
-		this->memAccess = true;
-		break;
-	case InstrType_STORE:
-		this->srcOp1 = srcOp1;
-		this->srcOp2 = dstOp;
-		this->immediate = srcOp2;
-		this->dstOp = -1;
-		this->memAccess = true;
-		break;
-	default:
-		assert(0 && "Unsupported Instruction type");
-	}
+Instruction::Instruction() :
+		instrNumber(0), executeCycle(0),
+		srcOp1(-1), srcOp2(-1), immediate(-1), dstOp(-1), execTime(-1),
+		type(0), renamed(false), stagesReached(0), allocatedRS(-1) {
 }
 
-Instruction::~Instruction() {
+void Instruction::init(InstrNum instrNumber, const StaticInstruction& staticInst) {
+	*this = Instruction();
+	this->instrNumber = instrNumber;
+	type = staticInst.type;
+	srcOp1 = staticInst.srcOp1;
+	srcOp2 = staticInst.srcOp2;
+	immediate = staticInst.immediate;
+	dstOp = staticInst.dstOp;
 }
 
 void Instruction::setSrcPhysicalReg1(uint32_t physicalRegNum, bool readyBit) {
@@ -98,32 +69,22 @@ bool Instruction::isLoadStoreInst() const {
 }
 
 bool Instruction::hasIssued() const {
-	return issueCycle != -1;
+	return hasReachedStage(Stage_ISSUE);
 }
 
 bool Instruction::hasCompleted() const {
-	return completeCycle != -1;
+	return hasReachedStage(Stage_COMPLETE);
 }
 
 bool Instruction::hasRetired() const {
-	return retireCycle != -1;
+	return hasReachedStage(Stage_RETIRE);
 }
 
 RSType Instruction::getReservationStation() {
-	switch(type) {
-	case InstrType_REG:
-	case InstrType_IMM:
-		return RSType_ALU;
-	case InstrType_LOAD:
-		return RSType_LOAD;
-	case InstrType_STORE:
-		return RSType_STORE;
-	}
-	return RSType_UNKNOWN;
+	return StaticInstruction::reservationStationFor(type);
 }
 
-std::string Instruction::toString() const {
-	std::stringstream str;
+void Instruction::print(std::ostream& str) const {
 	if(renamed == false) {
 		str << "[inst " << instrNumber << ":\t" << type << " [AR#" << srcOp1;
 		switch(type) {
@@ -160,6 +121,10 @@ std::string Instruction::toString() const {
 			assert(0 && "Unsupported Instruction type");
 		}
 	}
+}
 
+std::string Instruction::toString() const {
+	std::stringstream str;
+	print(str);
 	return str.str();
 }
@@ -6,40 +6,43 @@
 #include <iostream>
 
 #include "utils.h"
+#include "instruction_trace.h"
 #include "physical_register.h"
 
-class ReservationStation;
-
+/*
+ * In-flight state of one instruction between dispatch and retire, used by
+ * the back-end pipeline stages, the RoB and the reservation stations.
+ * Records come from an InstructionPool and are recycled at retire; they are
+ * kept to one cache line, so the trace itself lives in InstructionTrace and
+ * the timestamps in TimingHistory.
+ */
 class Instruction {
-	uint32_t instrNumber;
-	char type;
-	uint32_t srcOp1;
-	uint32_t srcOp2;
-	uint32_t immediate;
-	uint32_t dstOp;
-	bool memAccess;
+	InstrNum instrNumber;
+	// Cycle the instruction started execution, to time its completion.
+	Cycle executeCycle;
 
 	// For using in reservation station
 	PhysicalRegister srcPhysicalReg1;
 	PhysicalRegister srcPhysicalReg2;
 	PhysicalRegister dstPhysicalReg;
 
-	ReservationStation* allocatedRS;
+	uint32_t srcOp1;
+	uint32_t srcOp2;
+	uint32_t immediate;
+	uint32_t dstOp;
+	uint32_t execTime;
 
+	char type;
 	bool renamed;
-	uint32_t fetchCycle;
-	uint32_t decodeCycle;
-	uint32_t dispatchCycle;
-	uint32_t issueCycle;
-	uint32_t executeCycle;
-	uint32_t completeCycle;
-	uint32_t retireCycle;
-
-	uint32_t execTime;
+	// Bit s is set once the instruction has entered stage s.
+	uint8_t stagesReached;
+	// Index of the reservation station the instruction was dispatched to.
+	uint8_t allocatedRS;
 public:
-	Instruction(uint32_t instrNumber, char type,
-			uint32_t srcOp1, uint32_t srcOp2, uint32_t dstOp);
-	virtual ~Instruction();
+	Instruction();
+
+	// Starts tracking a newly fetched instruction.
+	void init(InstrNum instrNumber, const StaticInstruction& staticInst);
 
 	void setSrcPhysicalReg1(uint32_t physicalRegNum, bool readyBit);
 	void setSrcPhysicalReg2(uint32_t physicalRegNum, bool readyBit);
@@ -62,22 +65,25 @@ public:
 
 	RSType getReservationStation();
 
+	void print(std::ostream& out) const;
 	std::string toString() const;
 
-	uint32_t getCompleteCycle() const {
-		return completeCycle;
+	InstrNum getInstrNumber() const {
+		return instrNumber;
 	}
-
-	void setCompleteCycle(uint32_t completeCycle) {
-		this->completeCycle = completeCycle;
+	void setInstrNumber(InstrNum instrNumber) {
+		this->instrNumber = instrNumber;
+	}
+	uint8_t getStagesReached() const {
+		return stagesReached;
 	}
 
-	uint32_t getDecodeCycle() const {
-		return decodeCycle;
+	bool hasReachedStage(TimingStage stage) const {
+		return stagesReached & (1 << stage);
 	}
 
-	void setDecodeCycle(uint32_t decodeCycle) {
-		this->decodeCycle = decodeCycle;
+	void markStageReached(TimingStage stage) {
+		stagesReached |= 1 << stage;
 	}
 
 	uint32_t getDstOp() const {
@@ -88,30 +94,14 @@ public:
 		this->dstOp = dstOp;
 	}
 
-	uint32_t getDispatchCycle() const {
-		return dispatchCycle;
-	}
-
-	void setDispatchCycle(uint32_t dispatchCycle) {
-		this->dispatchCycle = dispatchCycle;
-	}
-
-	uint32_t getExecuteCycle() const {
+	Cycle getExecuteCycle() const {
 		return executeCycle;
 	}
 
-	void setExecuteCycle(uint32_t executeCycle) {
+	void setExecuteCycle(Cycle executeCycle) {
 		this->executeCycle = executeCycle;
 	}
 
-	uint32_t getFetchCycle() const {
-		return fetchCycle;
-	}
-
-	void setFetchCycle(uint32_t fetchCycle) {
-		this->fetchCycle = fetchCycle;
-	}
-
 	uint32_t getImmediate() const {
 		return immediate;
 	}
@@ -120,22 +110,6 @@ public:
 		this->immediate = immediate;
 	}
 
-	uint32_t getIssueCycle() const {
-		return issueCycle;
-	}
-
-	void setIssueCycle(uint32_t issueCycle) {
-		this->issueCycle = issueCycle;
-	}
-
-	bool isMemAccess() const {
-		return memAccess;
-	}
-
-	void setMemAccess(bool memAccess) {
-		this->memAccess = memAccess;
-	}
-
 	bool isRenamed() const {
 		return renamed;
 	}
@@ -144,14 +118,6 @@ public:
 		this->renamed = renamed;
 	}
 
-	uint32_t getRetireCycle() const {
-		return retireCycle;
-	}
-
-	void setRetireCycle(uint32_t retireCycle) {
-		this->retireCycle = retireCycle;
-	}
-
 	uint32_t getSrcOp1() const {
 		return srcOp1;
 	}
@@ -184,13 +150,15 @@ public:
 		this->execTime = execTime;
 	}
 
-	ReservationStation* getAllocatedRs() const {
+	uint8_t getAllocatedRs() const {
 		return allocatedRS;
 	}
 
-	void setAllocatedRs(ReservationStation* allocatedRs) {
+	void setAllocatedRs(uint8_t allocatedRs) {
 		allocatedRS = allocatedRs;
 	}
 };
 
+static_assert(sizeof(Instruction) <= 64, "Instruction must fit in a cache line");
+
 #endif /* SRC_INSTRUCTION_H_ */
@@ -0,0 +1,45 @@
+#include "instruction_pool.h"
+#include <cstdlib>
+#include <new>
+
+#define CACHE_LINE_SIZE 64
+
+InstructionPool::InstructionPool(uint32_t chunkSize) : chunkSize(chunkSize) {
+	addChunk();
+}
+
+InstructionPool::~InstructionPool() {
+	for(Instruction* chunk : chunks)
+		::free(chunk);
+}
+
+void InstructionPool::addChunk() {
+	void* memory = nullptr;
+	if(posix_memalign(&memory, CACHE_LINE_SIZE, chunkSize * sizeof(Instruction)) != 0)
+		throw std::bad_alloc();
+	Instruction* chunk = static_cast<Instruction*>(memory);
+	chunks.push_back(chunk);
+	freeRecords.reserve(chunks.size() * chunkSize);
+	// Hand out records in address order.
+	for(uint32_t i = chunkSize; i > 0; i--)
+		freeRecords.push_back(new (&chunk[i - 1]) Instruction());
+}
+
+Instruction* InstructionPool::allocate() {
+	if(freeRecords.empty())
+		addChunk();
+	Instruction* inst = freeRecords.back();
+	freeRecords.pop_back();
+	return inst;
+}
+
+void InstructionPool::release(Instruction* inst) {
+	freeRecords.push_back(inst);
+}
+
+void InstructionPool::reset() {
+	freeRecords.clear();
+	for(int c = chunks.size() - 1; c >= 0; c--)
+		for(uint32_t i = chunkSize; i > 0; i--)
+			freeRecords.push_back(&chunks[c][i - 1]);
+}
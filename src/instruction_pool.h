@@ -0,0 +1,33 @@
+#ifndef SRC_INSTRUCTION_POOL_H_
+#define SRC_INSTRUCTION_POOL_H_
+
+#include <vector>
+
+#include "instruction.h"
+#include "utils.h"
+
+/*
+ * Recycles in-flight Instruction records. Records are carved out of
+ * cache-line aligned chunks, so a window of in-flight instructions is a few
+ * contiguous lines instead of scattered heap objects, and the pool stops
+ * allocating once it has grown to the largest window seen.
+ */
+class InstructionPool {
+	uint32_t chunkSize;
+	std::vector<Instruction*> chunks;
+	std::vector<Instruction*> freeRecords;
+
+	void addChunk();
+public:
+	InstructionPool(uint32_t chunkSize);
+	virtual ~InstructionPool();
+	InstructionPool(const InstructionPool&) = delete;
+	InstructionPool& operator=(const InstructionPool&) = delete;
+
+	Instruction* allocate();
+	void release(Instruction* inst);
+	// Returns every record to the pool.
+	void reset();
+};
+
+#endif /* SRC_INSTRUCTION_POOL_H_ */
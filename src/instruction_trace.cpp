@@ -0,0 +1,84 @@
+#include "instruction_trace.h"
+
+StaticInstruction StaticInstruction::decode(char type,
+		uint32_t srcOp1, uint32_t srcOp2, uint32_t dstOp) {
+	StaticInstruction inst;
+	inst.type = type;
+	inst.srcOp1 = srcOp1;
+	switch(type) {
+	case InstrType_REG:
+		inst.srcOp2 = srcOp2;
+		inst.immediate = -1;
+		inst.dstOp = dstOp;
+		break;
+	case InstrType_IMM:
+	case InstrType_LOAD:
+		inst.srcOp2 = -1;
+		inst.immediate = srcOp2;
+		inst.dstOp = dstOp;
+		break;
+	case InstrType_STORE:
+		inst.srcOp2 = dstOp;
+		inst.immediate = srcOp2;
+		inst.dstOp = -1;
+		break;
+	default:
+		assert(0 && "Unsupported Instruction type");
+	}
+	return inst;
+}
+
+void StaticInstruction::encode(uint32_t& rawSrcOp1,
+		uint32_t& rawSrcOp2, uint32_t& rawDstOp) const {
+	rawSrcOp1 = srcOp1;
+	switch(type) {
+	case InstrType_REG:
+		rawSrcOp2 = srcOp2;
+		rawDstOp = dstOp;
+		break;
+	case InstrType_IMM:
+	case InstrType_LOAD:
+		rawSrcOp2 = immediate;
+		rawDstOp = dstOp;
+		break;
+	case InstrType_STORE:
+		rawSrcOp2 = immediate;
+		rawDstOp = srcOp2;
+		break;
+	default:
+		assert(0 && "Unsupported Instruction type");
+	}
+}
+
+RSType StaticInstruction::reservationStationFor(char type) {
+	switch(type) {
+	case InstrType_REG:
+	case InstrType_IMM:
+		return RSType_ALU;
+	case InstrType_LOAD:
+		return RSType_LOAD;
+	case InstrType_STORE:
+		return RSType_STORE;
+	}
+	return RSType_UNKNOWN;
+}
+
+InstructionTrace::InstructionTrace() : hash(FNV1A_OFFSET_BASIS) {
+}
+
+InstructionTrace::~InstructionTrace() {
+}
+
+void InstructionTrace::addInstruction(char type,
+		uint32_t srcOp1, uint32_t srcOp2, uint32_t dstOp) {
+	instructions.push_back(StaticInstruction::decode(type, srcOp1, srcOp2, dstOp));
+	hash = fnv1aUpdate(hash, type);
+	hash = fnv1aUpdate(hash, srcOp1);
+	hash = fnv1aUpdate(hash, srcOp2);
+	hash = fnv1aUpdate(hash, dstOp);
+}
+
+void InstructionTrace::clear() {
+	instructions.clear();
+	hash = FNV1A_OFFSET_BASIS;
+}
@@ -0,0 +1,59 @@
+#ifndef SRC_INSTRUCTION_TRACE_H_
+#define SRC_INSTRUCTION_TRACE_H_
+
+#include <vector>
+
+#include "utils.h"
+
+// Static fields of one trace instruction, decoded from the input format.
+// Unused operands are -1.
+struct StaticInstruction {
+	uint32_t srcOp1;
+	uint32_t srcOp2;
+	uint32_t immediate;
+	uint32_t dstOp;
+	char type;
+
+	static StaticInstruction decode(char type,
+			uint32_t srcOp1, uint32_t srcOp2, uint32_t dstOp);
+
+	// Inverse of decode(): the operands as written in the input file.
+	void encode(uint32_t& rawSrcOp1, uint32_t& rawSrcOp2, uint32_t& rawDstOp) const;
+
+	static RSType reservationStationFor(char type);
+	static bool isValidType(char type) {
+		return type == InstrType_REG || type == InstrType_IMM ||
+				type == InstrType_LOAD || type == InstrType_STORE;
+	}
+
+	RSType getReservationStation() const {
+		return reservationStationFor(type);
+	}
+};
+
+// The instructions to simulate, in program order.
+class InstructionTrace {
+	std::vector<StaticInstruction> instructions;
+	// Fingerprint of the trace, stored in binary output files.
+	uint64_t hash;
+public:
+	InstructionTrace();
+	virtual ~InstructionTrace();
+
+	void addInstruction(char type, uint32_t srcOp1, uint32_t srcOp2, uint32_t dstOp);
+	void clear();
+
+	InstrNum size() const {
+		return instructions.size();
+	}
+
+	const StaticInstruction& operator[](InstrNum instrNumber) const {
+		return instructions[instrNumber];
+	}
+
+	uint64_t getHash() const {
+		return hash;
+	}
+};
+
+#endif /* SRC_INSTRUCTION_TRACE_H_ */
@@ -0,0 +1,112 @@
+#include "interval_log.h"
+
+#include <cstdio>
+
+#define INTERVAL_LOG_MAGIC "R10KIVAL"
+#define INTERVAL_LOG_VERSION 1
+// Bytes buffered before they are written out.
+#define INTERVAL_LOG_BUFFER_SIZE (1 << 16)
+
+static void putFixed(std::string& buf, uint64_t value, int bytes) {
+	for(int i = 0; i < bytes; i++)
+		buf.push_back((char) ((value >> (8 * i)) & 0xff));
+}
+
+IntervalLog::IntervalLog() :
+	format(IntervalFormat_CSV), failed(false), lastCycle(0), lastRetired(0) {
+	last.clear();
+}
+
+IntervalLog::~IntervalLog() {
+	close();
+}
+
+bool IntervalLog::open(std::string path, IntervalFormat format, const CPUConfig& config,
+		Cycle cyclesPerRecord) {
+	close();
+	out.open(path, std::ios::binary);
+	if(!out.is_open()) {
+		std::cerr << "Cannot open interval log " << path << "\n";
+		return false;
+	}
+	this->path = path;
+	this->format = format;
+	failed = false;
+	buffer.reserve(INTERVAL_LOG_BUFFER_SIZE + 256);
+	restart();
+	if(format == IntervalFormat_CSV) {
+		buffer += "cycle,cycles,retired,ipc,rob_occupancy,stall_rob_full,stall_rs_busy,"
+				"stall_free_list_empty,free_registers,avg_free_registers\n";
+	}
+	else {
+		buffer += INTERVAL_LOG_MAGIC;
+		putFixed(buffer, INTERVAL_LOG_VERSION, 4);
+		putFixed(buffer, config.numArchRegs, 4);
+		putFixed(buffer, config.numPhysicalRegs, 4);
+		putFixed(buffer, config.robEntries, 4);
+		putFixed(buffer, config.width, 4);
+		putFixed(buffer, config.numLSQEntries, 4);
+		putFixed(buffer, cyclesPerRecord, 8);
+	}
+	return true;
+}
+
+void IntervalLog::flush() {
+	out.write(buffer.data(), buffer.size());
+	buffer.clear();
+	if(!out && !failed) {
+		std::cerr << "Cannot write interval log " << path << "\n";
+		failed = true;
+	}
+}
+
+bool IntervalLog::close() {
+	if(!out.is_open())
+		return true;
+	flush();
+	out.close();
+	return !failed && !out.fail();
+}
+
+void IntervalLog::restart() {
+	lastCycle = 0;
+	lastRetired = 0;
+	last.clear();
+}
+
+void IntervalLog::record(Cycle cycle, InstrNum retired, const PipelineCounters& counters,
+		uint32_t freeRegisters) {
+	if(!out.is_open() || cycle == lastCycle)
+		return;
+	PipelineCounters delta = counters;
+	delta.subtract(last);
+	Cycle numCycles = cycle - lastCycle;
+	InstrNum numRetired = retired - lastRetired;
+	if(format == IntervalFormat_CSV) {
+		char line[256];
+		snprintf(line, sizeof(line), "%llu,%llu,%llu,%.4f,%.2f,%llu,%llu,%llu,%u,%.2f\n",
+				(unsigned long long) cycle, (unsigned long long) numCycles,
+				(unsigned long long) numRetired, (double) numRetired / numCycles,
+				(double) delta.robOccupancy / numCycles,
+				(unsigned long long) delta.stalls[StallReason_ROB_FULL],
+				(unsigned long long) delta.stalls[StallReason_RS_BUSY],
+				(unsigned long long) delta.stalls[StallReason_FREE_LIST_EMPTY],
+				freeRegisters, (double) delta.freeRegisters / numCycles);
+		buffer += line;
+	}
+	else {
+		putFixed(buffer, cycle, 8);
+		putFixed(buffer, numCycles, 8);
+		putFixed(buffer, numRetired, 8);
+		putFixed(buffer, delta.robOccupancy, 8);
+		for(int i = 0; i < StallReason_COUNT; i++)
+			putFixed(buffer, delta.stalls[i], 8);
+		putFixed(buffer, delta.freeRegisters, 8);
+		putFixed(buffer, freeRegisters, 8);
+	}
+	if(buffer.size() >= INTERVAL_LOG_BUFFER_SIZE)
+		flush();
+	lastCycle = cycle;
+	lastRetired = retired;
+	last = counters;
+}
@@ -0,0 +1,66 @@
+#ifndef SRC_INTERVAL_LOG_H_
+#define SRC_INTERVAL_LOG_H_
+
+#include <fstream>
+#include <string>
+
+#include "cpu_config.h"
+#include "pipeline_counters.h"
+#include "utils.h"
+
+// Cycles per record unless told otherwise.
+#define INTERVAL_LOG_DEFAULT_CYCLES 10000
+
+enum IntervalFormat {
+	IntervalFormat_CSV,
+	IntervalFormat_BINARY
+};
+
+/*
+ * Time series of the pipeline: one record every so many cycles, written
+ * through a buffer. CSV files start with a header line naming the columns.
+ * Binary files are
+ *
+ *   "R10KIVAL" | version | config | cycles per record
+ *
+ * then one record after another, each the 64-bit little-endian fields
+ *
+ *   cycle | cycles | retired | robOccupancy | stalls (ROB full, RS busy,
+ *   free list empty) | freeRegisters sum | freeRegisters
+ *
+ * where cycle is the end of the record's interval, the last of which may
+ * be shorter, and the sums over its cycles give the averages.
+ */
+class IntervalLog {
+	std::ofstream out;
+	std::string path;
+	std::string buffer;
+	IntervalFormat format;
+	bool failed;
+	// Totals at the end of the last record.
+	Cycle lastCycle;
+	InstrNum lastRetired;
+	PipelineCounters last;
+
+	void flush();
+public:
+	IntervalLog();
+	virtual ~IntervalLog();
+	IntervalLog(const IntervalLog&) = delete;
+	IntervalLog& operator=(const IntervalLog&) = delete;
+
+	bool open(std::string path, IntervalFormat format, const CPUConfig& config,
+			Cycle cyclesPerRecord);
+	// Returns false if anything could not be written.
+	bool close();
+
+	// Records the cycles since the last record from the CPU's running
+	// totals at cycle, and the registers in the free list now. Does nothing
+	// if no cycle went by.
+	void record(Cycle cycle, InstrNum retired, const PipelineCounters& counters,
+			uint32_t freeRegisters);
+	// The CPU was reset: totals start from zero again.
+	void restart();
+};
+
+#endif /* SRC_INTERVAL_LOG_H_ */
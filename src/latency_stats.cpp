@@ -0,0 +1,131 @@
+#include "latency_stats.h"
+
+#include <algorithm>
+#include <iomanip>
+
+static const char* intervalNames[Latency_COUNT] = {
+	"decode->dispatch", "dispatch->issue", "issue->complete", "complete->retire"
+};
+
+// Stage each interval starts at; it ends at the next one listed.
+static const TimingStage intervalStages[Latency_COUNT + 1] = {
+	Stage_DECODE, Stage_DISPATCH, Stage_ISSUE, Stage_COMPLETE, Stage_RETIRE
+};
+
+const char* getLatencyIntervalName(LatencyInterval interval) {
+	return intervalNames[interval];
+}
+
+LatencyStats::LatencyStats(size_t numSlowest) :
+	numSlowest(numSlowest) {
+	slowest.reserve(numSlowest + 1);
+}
+
+LatencyStats::~LatencyStats() {
+}
+
+void LatencyStats::clear() {
+	for(int t = 0; t < NUM_INSTR_TYPES; t++)
+		for(int i = 0; i < Latency_COUNT; i++)
+			histograms[t][i].clear();
+	slowest.clear();
+}
+
+void LatencyStats::add(InstrNum instrNumber, char type, const TimingRow& row) {
+	Histogram* typeHistograms = histograms[getInstrTypeIndex(type)];
+	for(int i = 0; i < Latency_COUNT; i++)
+		typeHistograms[i].add(row.cycles[intervalStages[i + 1]] - row.cycles[intervalStages[i]]);
+	if(numSlowest == 0)
+		return;
+	Slow slow = { row.cycles[Stage_RETIRE] - row.cycles[Stage_FETCH], instrNumber, type };
+	if(slowest.size() == numSlowest) {
+		if(!(slow < slowest.front()))
+			return;
+		std::pop_heap(slowest.begin(), slowest.end());
+		slowest.pop_back();
+	}
+	slowest.push_back(slow);
+	std::push_heap(slowest.begin(), slowest.end());
+}
+
+std::vector<InstrNum> LatencyStats::getSlowest() const {
+	std::vector<Slow> sorted = slowest;
+	std::sort(sorted.begin(), sorted.end());
+	std::vector<InstrNum> numbers;
+	for(const Slow& slow : sorted)
+		numbers.push_back(slow.instrNumber);
+	return numbers;
+}
+
+void LatencyStats::writeChain(std::ostream& out, InstrNum instrNumber,
+		const TimingHistory& history, const std::vector<StallRow>& stalls) const {
+	for(int step = 0; step < LATENCY_CHAIN_LENGTH && instrNumber != INSTR_NONE; step++) {
+		TimingRow row;
+		history.getRow(instrNumber, row);
+		Cycle waits[Latency_COUNT];
+		for(int i = 0; i < Latency_COUNT; i++)
+			waits[i] = row.cycles[intervalStages[i + 1]] - row.cycles[intervalStages[i]];
+		out << "    " << (step ? "<- #" : "#") << instrNumber << ":";
+		for(int i = 0; i < Latency_COUNT; i++)
+			out << " " << intervalNames[i] << " " << waits[i];
+		if(instrNumber >= stalls.size()) {
+			out << "\n";
+			return;
+		}
+		// Carry on with whichever instruction this one waited for longer.
+		const StallRow& stall = stalls[instrNumber];
+		if(stall.dispatchStall != STALL_CODE_NONE)
+			out << ", dispatch stalled on " << getStallCodeName(stall.dispatchStall);
+		if(stall.issueProducer != INSTR_NONE)
+			out << ", src" << (int) stall.issueOperand << " from #" << stall.issueProducer;
+		if(stall.retireBlocker != INSTR_NONE)
+			out << ", retired after #" << stall.retireBlocker;
+		out << "\n";
+		if(stall.issueProducer != INSTR_NONE && (stall.retireBlocker == INSTR_NONE ||
+				waits[Latency_DISPATCH_ISSUE] >= waits[Latency_COMPLETE_RETIRE]))
+			instrNumber = stall.issueProducer;
+		else
+			instrNumber = stall.retireBlocker;
+	}
+}
+
+void LatencyStats::write(std::ostream& out, const TimingHistory& history,
+		const std::vector<StallRow>& stalls, bool withBuckets) const {
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	out << std::fixed << std::setprecision(2);
+	out << std::left << std::setw(6) << "type" << std::setw(18) << "interval" << std::right <<
+			std::setw(12) << "count" << std::setw(10) << "mean" << std::setw(8) << "p50" <<
+			std::setw(8) << "p90" << std::setw(8) << "p99" << std::setw(10) << "max" << "\n";
+	for(int t = 0; t < NUM_INSTR_TYPES; t++) {
+		for(int i = 0; i < Latency_COUNT; i++) {
+			const Histogram& histogram = histograms[t][i];
+			if(histogram.getCount() == 0)
+				continue;
+			out << std::left << std::setw(6) << getInstrType(t) << std::setw(18) <<
+					intervalNames[i] << std::right << std::setw(12) << histogram.getCount() <<
+					std::setw(10) << histogram.getMean() << std::setw(8) <<
+					histogram.getPercentile(0.5) << std::setw(8) << histogram.getPercentile(0.9) <<
+					std::setw(8) << histogram.getPercentile(0.99) << std::setw(10) <<
+					histogram.getMax() << "\n";
+			if(withBuckets)
+				histogram.write(out, "      ");
+		}
+	}
+	if(slowest.empty()) {
+		out.flags(flags);
+		out.precision(precision);
+		return;
+	}
+	out << "\nslowest instructions, fetch to retire:\n";
+	std::vector<Slow> sorted = slowest;
+	std::sort(sorted.begin(), sorted.end());
+	for(const Slow& slow : sorted) {
+		out << "  #" << slow.instrNumber << " " << slow.type << ": " << slow.latency << " cycles\n";
+		writeChain(out, slow.instrNumber, history, stalls);
+	}
+	if(stalls.empty())
+		out << "(stall chains need stall attribution)\n";
+	out.flags(flags);
+	out.precision(precision);
+}
@@ -0,0 +1,80 @@
+#ifndef SRC_LATENCY_STATS_H_
+#define SRC_LATENCY_STATS_H_
+
+#include <ostream>
+#include <vector>
+
+#include "histogram.h"
+#include "timing_file.h"
+#include "timing_history.h"
+#include "utils.h"
+
+// Slowest instructions kept unless told otherwise.
+#define LATENCY_DEFAULT_TOP 10
+// Instructions followed back from each of the slowest.
+#define LATENCY_CHAIN_LENGTH 8
+
+// Waits between stages reported by LatencyStats.
+enum LatencyInterval {
+	Latency_DECODE_DISPATCH,
+	Latency_DISPATCH_ISSUE,
+	Latency_ISSUE_COMPLETE,
+	Latency_COMPLETE_RETIRE,
+	Latency_COUNT
+};
+
+const char* getLatencyIntervalName(LatencyInterval interval);
+
+/*
+ * Histograms of the waits between stages by instruction type, and the
+ * instructions that took longest from fetch to retire, gathered as
+ * instructions retire (see BasicCPU::setLatencyStats()).
+ */
+class LatencyStats {
+	struct Slow {
+		Cycle latency;
+		InstrNum instrNumber;
+		char type;
+
+		// Orders the heap so that its front is the fastest kept.
+		bool operator<(const Slow& other) const {
+			return latency > other.latency ||
+					(latency == other.latency && instrNumber < other.instrNumber);
+		}
+	};
+
+	Histogram histograms[NUM_INSTR_TYPES][Latency_COUNT];
+	size_t numSlowest;
+	// Heap of the numSlowest slowest instructions so far.
+	std::vector<Slow> slowest;
+
+	void writeChain(std::ostream& out, InstrNum instrNumber, const TimingHistory& history,
+			const std::vector<StallRow>& stalls) const;
+public:
+	LatencyStats(size_t numSlowest = LATENCY_DEFAULT_TOP);
+	virtual ~LatencyStats();
+
+	void clear();
+	// Adds a retired instruction.
+	void add(InstrNum instrNumber, char type, const TimingRow& row);
+
+	const Histogram& getHistogram(char type, LatencyInterval interval) const {
+		return histograms[getInstrTypeIndex(type)][interval];
+	}
+
+	// Instruction numbers of the slowest instructions, slowest first.
+	std::vector<InstrNum> getSlowest() const;
+
+	/*
+	 * Summarizes every histogram and lists the slowest instructions with
+	 * their stall chains: from each, the producer or older instruction it
+	 * waited for longest, as recorded in stalls (see
+	 * BasicCPU::setStallAttribution()), and so on. Without stall
+	 * attribution, stalls is empty and chains stop at the first step.
+	 * withBuckets adds the buckets of every histogram.
+	 */
+	void write(std::ostream& out, const TimingHistory& history,
+			const std::vector<StallRow>& stalls, bool withBuckets) const;
+};
+
+#endif /* SRC_LATENCY_STATS_H_ */
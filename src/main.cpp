@@ -1,36 +1,196 @@
 #include <iostream>
 #include <fstream>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
 #include "utils.h"
 #include "cpu.h"
+#include "input_file.h"
+#include "stats_page.h"
+
+// Set while the simulation publishes to a stats file.
+static StatsPage* signalStatsPage = nullptr;
+
+// SIGUSR1 asks for a state snapshot without stopping the simulation.
+static void requestSnapshot(int) {
+	if(signalStatsPage)
+		signalStatsPage->requestSnapshot();
+}
+
+static void usage(const char* program) {
+	std::cout << "Usage : " << program << " [options] input_file output_file\n"
+			"  -b                binary output file (see timing_file.h)\n"
+			"  -x                extrapolate repeating loops\n"
+			"  -a                add why each instruction waited to the output file\n"
+			"  -s stats_file     publish progress for stats-monitor; SIGUSR1 writes\n"
+			"                    a pipeline snapshot next to it\n"
+			"  -e energy_table   print structure accesses and their energy\n"
+			"  -t interval_file  write IPC, occupancy and stalls per interval, as CSV\n"
+			"                    or binary if the name ends in .bin\n"
+			"  -n cycles         cycles per interval (" << INTERVAL_LOG_DEFAULT_CYCLES << ")\n"
+			"  -l num_slowest    print wait histograms and the slowest instructions,\n"
+			"                    with stall chains if -a is given too\n"
+			"  -r num_registers  rank registers by the waiting they caused, 0 for all\n"
+			"  -w                print ready instructions and dependency depth per cycle\n"
+			"  -k                print the slack of each instruction type\n"
+			"  -h                add the histogram buckets to -l and -k\n";
+}
 
 int main(int argc, char** argv) {
-	if(argc != 3) {
+	// The debug log goes to stderr a few fields at a time. Unbuffered,
+	// every field would be a write of its own, so stderr is buffered until
+	// the simulation ends.
+	static char debugLogBuffer[1 << 16];
+	setvbuf(stderr, debugLogBuffer, _IOFBF, sizeof(debugLogBuffer));
+	std::cerr.unsetf(std::ios::unitbuf);
+	bool binaryOutput = false;
+	bool stallAttribution = false;
+	bool extrapolate = false;
+	const char* statsFile = nullptr;
+	const char* energyFile = nullptr;
+	const char* intervalFile = nullptr;
+	Cycle intervalCycles = INTERVAL_LOG_DEFAULT_CYCLES;
+	bool latencyReport = false;
+	size_t numSlowest = LATENCY_DEFAULT_TOP;
+	bool hotSpotReport = false;
+	size_t numHotSpots = 0;
+	bool windowReport = false;
+	bool slackReport = false;
+	bool histogramBuckets = false;
+	int arg = 1;
+	for(; arg < argc && argv[arg][0] == '-'; arg++) {
+		if(strcmp(argv[arg], "-b") == 0)
+			binaryOutput = true;
+		else if(strcmp(argv[arg], "-x") == 0)
+			extrapolate = true;
+		else if(strcmp(argv[arg], "-a") == 0)
+			stallAttribution = true;
+		else if(strcmp(argv[arg], "-s") == 0 && arg + 1 < argc)
+			statsFile = argv[++arg];
+		else if(strcmp(argv[arg], "-e") == 0 && arg + 1 < argc)
+			energyFile = argv[++arg];
+		else if(strcmp(argv[arg], "-t") == 0 && arg + 1 < argc)
+			intervalFile = argv[++arg];
+		else if(strcmp(argv[arg], "-n") == 0 && arg + 1 < argc)
+			intervalCycles = strtoull(argv[++arg], nullptr, 10);
+		else if(strcmp(argv[arg], "-l") == 0 && arg + 1 < argc) {
+			latencyReport = true;
+			numSlowest = strtoul(argv[++arg], nullptr, 10);
+		}
+		else if(strcmp(argv[arg], "-r") == 0 && arg + 1 < argc) {
+			hotSpotReport = true;
+			numHotSpots = strtoul(argv[++arg], nullptr, 10);
+		}
+		else if(strcmp(argv[arg], "-w") == 0)
+			windowReport = true;
+		else if(strcmp(argv[arg], "-k") == 0)
+			slackReport = true;
+		else if(strcmp(argv[arg], "-h") == 0)
+			histogramBuckets = true;
+		else
+			break;
+	}
+	if(argc - arg != 2) {
 		std::cout << "Error: Not enough arguments!\n";
-		std::cout << "Usage : " << argv[0] << " input_file output_file\n";
+		usage(argv[0]);
+		exit(-1);
+	}
+	if(binaryOutput && stallAttribution) {
+		std::cout << "Error: stall attribution is only written to text output files\n";
 		exit(-1);
 	}
-	std::ifstream in(argv[1]);
+	const char* inputFile = argv[arg];
+	const char* outputFile = argv[arg + 1];
 
-	uint32_t numArchRegs, numPhysicalRegs, robEntries, width, numLSQEntries;
-	in >> numArchRegs >> numPhysicalRegs >> robEntries >> width >> numLSQEntries;
-	CPU* cpu = new CPU(numArchRegs, numPhysicalRegs, robEntries, width, numLSQEntries);
-	PRINT(numArchRegs);
-	PRINT(numPhysicalRegs);
-	PRINT(robEntries);
-	PRINT(width);
-	PRINT(numLSQEntries);
-	char instType;
-	uint32_t instSrcOp1, instSrcOp2, instDstOp;
-	int count = 0;
-	while(in >> instType) {
-		in >> instSrcOp1 >> instSrcOp2 >> instDstOp;
-		cpu->addInstruction(instType, instSrcOp1, instSrcOp2, instDstOp);
-		std::cerr << count << " " << instType << " " << instSrcOp1 << " " << instSrcOp2 << " " << instDstOp << "\n";
-		count++;
+	// Binary and compressed traces are streamed rather than listed.
+	TraceFormat format;
+	if(!detectTraceFormat(inputFile, format))
+		exit(-1);
+	CPUConfig config;
+	InstructionTrace trace;
+	TraceSource* source = nullptr;
+	if(format == TraceFormat_TEXT) {
+		if(!readInputFile(inputFile, config, trace))
+			exit(-1);
+	}
+	else {
+		source = openTraceSource(inputFile);
+		if(source == nullptr || !source->getConfig(config))
+			exit(-1);
+	}
+	EnergyTable energyTable;
+	if(energyFile && !readEnergyTable(energyFile, energyTable))
+		exit(-1);
+	CPU* cpu = new CPU(config);
+	cpu->setDebugLog(&std::cerr);
+	std::cerr << "numArchRegs=" << config.numArchRegs << "\n";
+	std::cerr << "numPhysicalRegs=" << config.numPhysicalRegs << "\n";
+	std::cerr << "robEntries=" << config.robEntries << "\n";
+	std::cerr << "width=" << config.width << "\n";
+	std::cerr << "numLSQEntries=" << config.numLSQEntries << "\n";
+	for(InstrNum i = 0; i < trace.size(); i++) {
+		uint32_t instSrcOp1, instSrcOp2, instDstOp;
+		trace[i].encode(instSrcOp1, instSrcOp2, instDstOp);
+		std::cerr << i << " " << trace[i].type << " " << instSrcOp1 << " " << instSrcOp2 << " " << instDstOp << "\n";
+	}
+	if(source)
+		cpu->setTraceSource(source);
+	else
+		cpu->setTrace(trace);
+	cpu->setExtrapolation(extrapolate);
+	cpu->setStallAttribution(stallAttribution);
+	StatsPage statsPage;
+	if(statsFile) {
+		if(!statsPage.open(statsFile, config))
+			exit(-1);
+		cpu->setStatsPage(&statsPage);
+		signalStatsPage = &statsPage;
+		signal(SIGUSR1, requestSnapshot);
+	}
+	LatencyStats latencyStats(numSlowest);
+	if(latencyReport)
+		cpu->setLatencyStats(&latencyStats);
+	RegisterHotSpots registerHotSpots;
+	if(hotSpotReport)
+		cpu->setRegisterHotSpots(&registerHotSpots);
+	WindowStats windowStats;
+	if(windowReport)
+		cpu->setWindowStats(&windowStats);
+	SlackStats slackStats(config);
+	if(slackReport)
+		cpu->setSlackStats(&slackStats);
+	IntervalLog intervalLog;
+	if(intervalFile) {
+		std::string name = intervalFile;
+		bool binary = name.size() >= 4 && name.compare(name.size() - 4, 4, ".bin") == 0;
+		if(!intervalLog.open(name, binary ? IntervalFormat_BINARY : IntervalFormat_CSV,
+				config, intervalCycles))
+			exit(-1);
+		cpu->setIntervalLog(&intervalLog, intervalCycles);
 	}
 	cpu->simulate();
-	cpu->generateOutputFile(argv[2]);
+	std::cerr.flush();
+	signalStatsPage = nullptr;
+	if(intervalFile && !intervalLog.close())
+		exit(-1);
+	if(latencyReport)
+		latencyStats.write(std::cout, cpu->getHistory(), cpu->getStallHistory(),
+				histogramBuckets);
+	if(hotSpotReport)
+		registerHotSpots.write(std::cout, numHotSpots);
+	if(windowReport)
+		windowStats.write(std::cout);
+	if(slackReport)
+		slackStats.write(std::cout, histogramBuckets);
+	if(energyFile)
+		writeAccessReport(std::cout, cpu->getAccessCounters(), &energyTable, cpu->getStats().cycles);
+	if(binaryOutput)
+		cpu->generateBinaryOutputFile(outputFile);
+	else
+		cpu->generateOutputFile(outputFile);
+	delete cpu;
+	delete source;
 	return 0;
 }
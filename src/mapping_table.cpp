@@ -59,13 +59,17 @@ PhysicalRegister MappingTable::getMapping(uint32_t archRegNum) {
 	return mapping[archRegNum];
 }
 
-std::string MappingTable::toString() {
-	std::stringstream str;
-	str << "[" << name << ":\n";
+void MappingTable::print(std::ostream& out) const {
+	out << "[" << name << ":\n";
 	for(int i = 0; i < numArchRegs; i++) {
-		str << "\tAR#" << i << "->PR#" << mapping[i].getRegNum() <<
+		out << "\tAR#" << i << "->PR#" << mapping[i].getRegNum() <<
 				(mapping[i].isReady() ? "+\n" : "\n");
 	}
-	str << "]";
+	out << "]";
+}
+
+std::string MappingTable::toString() {
+	std::stringstream str;
+	print(str);
 	return str.str();
 }
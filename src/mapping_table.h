@@ -23,6 +23,7 @@ public:
 	void setMapping(uint32_t archRegNum, PhysicalRegister physicalReg);
 	PhysicalRegister getMapping(uint32_t archRegNum);
 
+	void print(std::ostream& out) const;
 	std::string toString();
 };
 
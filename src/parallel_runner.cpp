@@ -0,0 +1,166 @@
+#include "parallel_runner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+ParallelRunner::ParallelRunner(const std::vector<CPUConfig>& configs, TraceSource* source) :
+	fanout(source), configs(configs), numThreads(1), extrapolation(false),
+	timingHistory(false), running(configs.size(), true) {
+	if(!fanout.rewind())
+		std::cerr << "Cannot read the trace from the start\n";
+}
+
+ParallelRunner::~ParallelRunner() {
+	for(BatchedCPU* batch : batches)
+		delete batch;
+	for(CPU* cpu : cpus)
+		delete cpu;
+}
+
+void ParallelRunner::build() {
+	members.resize(configs.size());
+	if(extrapolation) {
+		for(size_t i = 0; i < configs.size(); i++) {
+			members[i].unit = batches.size() + cpus.size();
+			members[i].lane = 0;
+			CPU* cpu = new CPU(configs[i]);
+			cpu->setExtrapolation(true);
+			cpus.push_back(cpu);
+		}
+	}
+	else {
+		// Configurations that can share a batch, in the order they come.
+		std::vector<std::vector<size_t>> groups;
+		for(size_t i = 0; i < configs.size(); i++) {
+			size_t g = 0;
+			while(g < groups.size() && !BatchedCPU::canBatch(configs[groups[g][0]], configs[i]))
+				g++;
+			if(g == groups.size())
+				groups.push_back(std::vector<size_t>());
+			groups[g].push_back(i);
+		}
+		// Every group gets its share of the threads, at least one batch.
+		for(const std::vector<size_t>& group : groups) {
+			size_t numBatches = std::max<size_t>(1, std::min<size_t>(group.size(),
+					(numThreads * group.size() + configs.size() - 1) / configs.size()));
+			for(size_t b = 0; b < numBatches; b++) {
+				std::vector<CPUConfig> lanes;
+				for(size_t k = b * group.size() / numBatches; k < (b + 1) * group.size() / numBatches; k++) {
+					members[group[k]].unit = batches.size();
+					members[group[k]].lane = lanes.size();
+					lanes.push_back(configs[group[k]]);
+				}
+				batches.push_back(new BatchedCPU(lanes));
+			}
+		}
+	}
+	for(BatchedCPU* batch : batches) {
+		batch->setTraceSource(fanout.addReader());
+		batch->setTimingHistory(timingHistory);
+	}
+	for(CPU* cpu : cpus)
+		cpu->setTraceSource(fanout.addReader());
+	unitRunning.resize(getNumUnits());
+	for(size_t u = 0; u < batches.size(); u++)
+		unitRunning[u] = batches[u]->getNumRunning() > 0;
+	for(size_t u = 0; u < cpus.size(); u++)
+		unitRunning[batches.size() + u] = !cpus[u]->isFinished();
+	updateRunning();
+}
+
+void ParallelRunner::updateRunning() {
+	for(size_t i = 0; i < configs.size(); i++) {
+		const Member& member = members[i];
+		if(member.unit < batches.size())
+			running[i] = batches[member.unit]->isRunning(member.lane);
+		else
+			running[i] = unitRunning[member.unit];
+	}
+}
+
+CPUStats ParallelRunner::getStats(size_t config) const {
+	const Member& member = members[config];
+	if(member.unit < batches.size())
+		return batches[member.unit]->getStats(member.lane);
+	return cpus[member.unit - batches.size()]->getStats();
+}
+
+void ParallelRunner::collectTimings(size_t config, TimingFile& timings) {
+	const Member& member = members[config];
+	if(member.unit < batches.size())
+		batches[member.unit]->collectTimings(member.lane, timings);
+	else
+		cpus[member.unit - batches.size()]->collectTimings(timings);
+}
+
+void ParallelRunner::stepUnits(Cycle numCycles) {
+	std::atomic<size_t> next(0);
+	auto work = [&]() {
+		for(size_t u = next++; u < getNumUnits(); u = next++) {
+			if(!unitRunning[u])
+				continue;
+			if(u < batches.size())
+				unitRunning[u] = batches[u]->step(numCycles) > 0;
+			else {
+				CPU* cpu = cpus[u - batches.size()];
+				cpu->step(numCycles);
+				CPUStats stats = cpu->getStats();
+				unitRunning[u] = !stats.finished && !stats.stuck;
+			}
+			if(!unitRunning[u])
+				fanout.stopReader(u);
+		}
+	};
+	std::vector<std::thread> threads;
+	for(unsigned i = 1; i < std::min<size_t>(numThreads, getNumUnits()); i++)
+		threads.push_back(std::thread(work));
+	work();
+	for(std::thread& thread : threads)
+		thread.join();
+	updateRunning();
+}
+
+void ParallelRunner::simulate() {
+	step(UINT64_MAX);
+}
+
+size_t ParallelRunner::step(Cycle numCycles) {
+	if(members.empty())
+		build();
+	for(Cycle done = 0; done < numCycles; done += PARALLEL_RUNNER_CHUNK_CYCLES) {
+		if(std::count(unitRunning.begin(), unitRunning.end(), 1) == 0)
+			break;
+		stepUnits(std::min<Cycle>(numCycles - done, PARALLEL_RUNNER_CHUNK_CYCLES));
+	}
+	return std::count(running.begin(), running.end(), 1);
+}
+
+void ParallelRunner::cancel(size_t config) {
+	if(!running[config])
+		return;
+	running[config] = false;
+	const Member& member = members[config];
+	if(member.unit < batches.size()) {
+		batches[member.unit]->cancel(member.lane);
+		if(batches[member.unit]->getNumRunning() > 0)
+			return;
+	}
+	unitRunning[member.unit] = false;
+	fanout.stopReader(member.unit);
+}
+
+void ParallelRunner::reset() {
+	if(!fanout.rewind())
+		std::cerr << "Cannot read the trace from the start\n";
+	for(size_t u = 0; u < batches.size(); u++) {
+		batches[u]->reset();
+		unitRunning[u] = batches[u]->getNumRunning() > 0;
+	}
+	for(size_t u = 0; u < cpus.size(); u++) {
+		cpus[u]->reset();
+		unitRunning[batches.size() + u] = !cpus[u]->isFinished();
+	}
+	if(!members.empty())
+		updateRunning();
+}
@@ -0,0 +1,104 @@
+#ifndef SRC_PARALLEL_RUNNER_H_
+#define SRC_PARALLEL_RUNNER_H_
+
+#include <vector>
+
+#include "batched_cpu.h"
+#include "cpu.h"
+#include "trace_fanout.h"
+#include "trace_source.h"
+#include "utils.h"
+
+// Cycles every batch runs before the batches wait for each other.
+#define PARALLEL_RUNNER_CHUNK_CYCLES (1 << 14)
+
+/*
+ * Runs one trace on several configurations, e.g. for a sweep.
+ * Configurations with the same width and numArchRegs run as lanes of a
+ * BatchedCPU, which shares the front end between them; they are split
+ * into at most one batch per thread. With extrapolation, which a
+ * BatchedCPU does not do, every configuration gets a CPU of its own
+ * instead. Reading and parsing the trace is shared by all of them through
+ * a TraceFanout. They run in chunks, spread over threads if asked to, and
+ * wait for each other after every chunk so that only a short stretch of
+ * the trace is held in memory. Each configuration gives exactly the
+ * results a CPU would simulating the trace on its own.
+ *
+ *   ParallelRunner sweep(configs, source);
+ *   sweep.setNumThreads(4);
+ *   sweep.simulate();
+ *   Cycle cycles = sweep.getStats(2).cycles;
+ */
+class ParallelRunner {
+	TraceFanout fanout;
+	std::vector<CPUConfig> configs;
+	unsigned numThreads;
+	bool extrapolation;
+	bool timingHistory;
+	// Built by the first step(); fanout reader i goes to batch i, the
+	// readers after them to the CPUs.
+	std::vector<BatchedCPU*> batches;
+	std::vector<CPU*> cpus;
+	// Per configuration: the batch or CPU it runs on, CPUs being numbered
+	// after the batches, and its lane in a batch.
+	struct Member {
+		size_t unit;
+		size_t lane;
+	};
+	std::vector<Member> members;
+	// Per configuration: has neither finished nor got stuck.
+	std::vector<char> running;
+	// Per batch and CPU: has a configuration still running.
+	std::vector<char> unitRunning;
+
+	void build();
+	size_t getNumUnits() const {
+		return batches.size() + cpus.size();
+	}
+	void stepUnits(Cycle numCycles);
+	void updateRunning();
+public:
+	// source must outlive the ParallelRunner.
+	ParallelRunner(const std::vector<CPUConfig>& configs, TraceSource* source);
+	virtual ~ParallelRunner();
+	ParallelRunner(const ParallelRunner&) = delete;
+	ParallelRunner& operator=(const ParallelRunner&) = delete;
+
+	void setNumThreads(unsigned numThreads) {
+		this->numThreads = numThreads ? numThreads : 1;
+	}
+
+	// See BasicCPU::setExtrapolation(). Only before the first step().
+	void setExtrapolation(bool enabled) {
+		extrapolation = enabled;
+	}
+
+	// Needed for collectTimings(). Only before the first step().
+	void setTimingHistory(bool enabled) {
+		timingHistory = enabled;
+	}
+
+	size_t size() const {
+		return configs.size();
+	}
+
+	bool isRunning(size_t config) const {
+		return running[config];
+	}
+
+	// Only after the first step().
+	CPUStats getStats(size_t config) const;
+	void collectTimings(size_t config, TimingFile& timings);
+
+	// Runs until every configuration has finished or got stuck.
+	void simulate();
+	// Runs every configuration still running for at most numCycles cycles
+	// and returns how many are still running.
+	size_t step(Cycle numCycles);
+	// Stops simulating config until reset().
+	void cancel(size_t config);
+	// Restarts every configuration from cycle 0.
+	void reset();
+};
+
+#endif /* SRC_PARALLEL_RUNNER_H_ */
@@ -4,15 +4,16 @@ PhysicalRegister::PhysicalRegister() : regNum(-1), ready(false) {
 
 }
 
-PhysicalRegister::~PhysicalRegister() {
+void PhysicalRegister::print(std::ostream& out) const {
+	if(regNum == -1)
+		out << -1;
+	else {
+		out << regNum << (ready ? '+' : ' ');
+	}
 }
 
 std::string PhysicalRegister::toString() {
 	std::stringstream str;
-	if(regNum == -1)
-		str << -1;
-	else {
-		str << regNum << (ready ? '+' : ' ');
-	}
+	print(str);
 	return str.str();
 }
@@ -3,12 +3,13 @@
 
 #include "utils.h"
 
+// Plain value type (no virtual destructor) so the copies held by every
+// in-flight instruction stay at eight bytes.
 class PhysicalRegister {
 	uint32_t regNum;
 	bool ready;
 public:
 	PhysicalRegister();
-	virtual ~PhysicalRegister();
 
 	bool isReady() const {
 		return ready;
@@ -26,6 +27,7 @@ public:
 		this->regNum = regNum;
 	}
 
+	void print(std::ostream& out) const;
 	std::string toString();
 };
 
@@ -0,0 +1,52 @@
+#ifndef SRC_PIPELINE_COUNTERS_H_
+#define SRC_PIPELINE_COUNTERS_H_
+
+#include "access_counters.h"
+#include "pipeline_observer.h"
+#include "utils.h"
+
+// Running totals kept by BasicCPU since the last reset(); the difference
+// of two readings describes the cycles in between.
+struct PipelineCounters {
+	AccessCounters accesses;
+	// Cycles in which dispatch stalled, by reason.
+	uint64_t stalls[StallReason_COUNT];
+	// Sums over cycles of the RoB entries in use and of the registers in
+	// the free list at the end of each cycle.
+	uint64_t robOccupancy;
+	uint64_t freeRegisters;
+
+	void clear() {
+		accesses.clear();
+		for(int i = 0; i < StallReason_COUNT; i++)
+			stalls[i] = 0;
+		robOccupancy = 0;
+		freeRegisters = 0;
+	}
+
+	void add(const PipelineCounters& other) {
+		accesses.add(other.accesses);
+		for(int i = 0; i < StallReason_COUNT; i++)
+			stalls[i] += other.stalls[i];
+		robOccupancy += other.robOccupancy;
+		freeRegisters += other.freeRegisters;
+	}
+
+	void subtract(const PipelineCounters& other) {
+		accesses.subtract(other.accesses);
+		for(int i = 0; i < StallReason_COUNT; i++)
+			stalls[i] -= other.stalls[i];
+		robOccupancy -= other.robOccupancy;
+		freeRegisters -= other.freeRegisters;
+	}
+
+	void multiply(uint64_t factor) {
+		accesses.multiply(factor);
+		for(int i = 0; i < StallReason_COUNT; i++)
+			stalls[i] *= factor;
+		robOccupancy *= factor;
+		freeRegisters *= factor;
+	}
+};
+
+#endif /* SRC_PIPELINE_COUNTERS_H_ */
@@ -0,0 +1,149 @@
+#ifndef SRC_PIPELINE_OBSERVER_H_
+#define SRC_PIPELINE_OBSERVER_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "instruction.h"
+#include "physical_register.h"
+#include "utils.h"
+
+// Why dispatch could not take the instruction at the head of its queue.
+enum StallReason {
+	StallReason_ROB_FULL,
+	StallReason_RS_BUSY,
+	StallReason_FREE_LIST_EMPTY,
+	StallReason_COUNT
+};
+
+/*
+ * Observer policies are plain classes with the callbacks below; BasicCPU
+ * calls them directly, so a policy whose callbacks are empty inline
+ * functions compiles away entirely. Fetch and decode happen before an
+ * instruction has an Instruction record, so they only get its number.
+ * onDispatch() receives the renamed instruction together with the T and
+ * Told registers written into the RoB (-1 for instructions without a
+ * destination).
+ *
+ * To write a policy, derive from NullObserver and hide the callbacks of
+ * interest, then instantiate BasicCPU<YourObserver> in a file that
+ * includes cpu_impl.h.
+ */
+class NullObserver {
+public:
+	void onFetch(Cycle /*cycle*/, InstrNum /*instrNumber*/) {
+	}
+
+	void onDecode(Cycle /*cycle*/, InstrNum /*instrNumber*/) {
+	}
+
+	void onDispatch(Cycle /*cycle*/, const Instruction& /*inst*/,
+			PhysicalRegister /*T*/, PhysicalRegister /*Told*/) {
+	}
+
+	void onIssue(Cycle /*cycle*/, const Instruction& /*inst*/) {
+	}
+
+	void onExecute(Cycle /*cycle*/, const Instruction& /*inst*/) {
+	}
+
+	void onComplete(Cycle /*cycle*/, const Instruction& /*inst*/) {
+	}
+
+	void onRetire(Cycle /*cycle*/, const Instruction& /*inst*/) {
+	}
+
+	// The instruction at the head of the dispatch queue was held back.
+	void onStall(Cycle /*cycle*/, InstrNum /*instrNumber*/, StallReason /*reason*/) {
+	}
+};
+
+// Interface for observers registered at runtime with ObserverList.
+class PipelineObserver {
+public:
+	virtual ~PipelineObserver() {
+	}
+
+	virtual void onFetch(Cycle /*cycle*/, InstrNum /*instrNumber*/) {
+	}
+
+	virtual void onDecode(Cycle /*cycle*/, InstrNum /*instrNumber*/) {
+	}
+
+	virtual void onDispatch(Cycle /*cycle*/, const Instruction& /*inst*/,
+			PhysicalRegister /*T*/, PhysicalRegister /*Told*/) {
+	}
+
+	virtual void onIssue(Cycle /*cycle*/, const Instruction& /*inst*/) {
+	}
+
+	virtual void onExecute(Cycle /*cycle*/, const Instruction& /*inst*/) {
+	}
+
+	virtual void onComplete(Cycle /*cycle*/, const Instruction& /*inst*/) {
+	}
+
+	virtual void onRetire(Cycle /*cycle*/, const Instruction& /*inst*/) {
+	}
+
+	virtual void onStall(Cycle /*cycle*/, InstrNum /*instrNumber*/, StallReason /*reason*/) {
+	}
+};
+
+// Policy forwarding every event to the observers added at runtime, in the
+// order they were added. Costs one virtual call per observer and event.
+class ObserverList {
+	std::vector<PipelineObserver*> observers;
+public:
+	void add(PipelineObserver* observer) {
+		observers.push_back(observer);
+	}
+
+	void remove(PipelineObserver* observer) {
+		observers.erase(std::remove(observers.begin(), observers.end(), observer),
+				observers.end());
+	}
+
+	void onFetch(Cycle cycle, InstrNum instrNumber) {
+		for(PipelineObserver* observer : observers)
+			observer->onFetch(cycle, instrNumber);
+	}
+
+	void onDecode(Cycle cycle, InstrNum instrNumber) {
+		for(PipelineObserver* observer : observers)
+			observer->onDecode(cycle, instrNumber);
+	}
+
+	void onDispatch(Cycle cycle, const Instruction& inst,
+			PhysicalRegister T, PhysicalRegister Told) {
+		for(PipelineObserver* observer : observers)
+			observer->onDispatch(cycle, inst, T, Told);
+	}
+
+	void onIssue(Cycle cycle, const Instruction& inst) {
+		for(PipelineObserver* observer : observers)
+			observer->onIssue(cycle, inst);
+	}
+
+	void onExecute(Cycle cycle, const Instruction& inst) {
+		for(PipelineObserver* observer : observers)
+			observer->onExecute(cycle, inst);
+	}
+
+	void onComplete(Cycle cycle, const Instruction& inst) {
+		for(PipelineObserver* observer : observers)
+			observer->onComplete(cycle, inst);
+	}
+
+	void onRetire(Cycle cycle, const Instruction& inst) {
+		for(PipelineObserver* observer : observers)
+			observer->onRetire(cycle, inst);
+	}
+
+	void onStall(Cycle cycle, InstrNum instrNumber, StallReason reason) {
+		for(PipelineObserver* observer : observers)
+			observer->onStall(cycle, instrNumber, reason);
+	}
+};
+
+#endif /* SRC_PIPELINE_OBSERVER_H_ */
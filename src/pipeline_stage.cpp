@@ -1,43 +1,127 @@
 #include "pipeline_stage.h"
 
+#define PIPELINE_STAGE_MIN_CAPACITY 8
+
 PipelineStage::PipelineStage(std::string name, uint32_t width) :
-	name(name), width(width) {
+	name(name), head(0), count(0), width(width) {
+	uint32_t capacity = PIPELINE_STAGE_MIN_CAPACITY;
+	while(capacity < 2 * width)
+		capacity *= 2;
+	queue.resize(capacity);
 }
 
 PipelineStage::~PipelineStage() {
 }
 
+void PipelineStage::grow() {
+	std::vector<Instruction*> bigger(queue.size() * 2);
+	for(uint32_t i = 0; i < count; i++)
+		bigger[i] = at(i);
+	queue.swap(bigger);
+	head = 0;
+}
+
 bool PipelineStage::push(Instruction* inst) {
-	queue.push_back(inst);
+	if(count == queue.size())
+		grow();
+	queue[(head + count) & (queue.size() - 1)] = inst;
+	count++;
 	return true;
 }
 
 bool PipelineStage::isEmpty() {
-	return queue.empty();
+	return count == 0;
 }
 
 Instruction* PipelineStage::front() {
-	if(queue.empty()) {
+	if(count == 0) {
 		std::cerr << name << " " << __func__ << " empty pipeline stage\n";
 		assert(0);
 	}
-	return queue[0];
+	return queue[head];
 }
 
 void PipelineStage::pop() {
-	if(queue.empty()) {
+	if(count == 0) {
 		std::cerr << name << " " << __func__ << " Pull from empty pipeline stage\n";
 		assert(0);
 	}
-	queue.erase(queue.begin());
+	head = (head + 1) & (queue.size() - 1);
+	count--;
+}
+
+void PipelineStage::erase(uint32_t i) {
+	if(i >= count) {
+		std::cerr << name << " " << __func__ << " invalid index : " << i << "\n";
+		assert(0);
+	}
+	uint32_t mask = queue.size() - 1;
+	for(; i + 1 < count; i++)
+		queue[(head + i) & mask] = queue[(head + i + 1) & mask];
+	count--;
+}
+
+void PipelineStage::print(std::ostream& out) const {
+	out << "[pipeline_stage " << name << " ";
+	for(uint32_t i = 0; i < count; i++) {
+		at(i)->print(out);
+		out << " ";
+	}
+	out << "]";
 }
 
 std::string PipelineStage::toString() {
 	std::stringstream str;
-	str << "[pipeline_stage " << name << " ";
-	for(auto inst : queue) {
-		str << inst->toString() << " ";
+	print(str);
+	return str.str();
+}
+
+InOrderStage::InOrderStage(std::string name) :
+	name(name), head(0), tail(0) {
+}
+
+InOrderStage::~InOrderStage() {
+}
+
+void InOrderStage::push(InstrNum instrNumber) {
+	if(instrNumber != tail) {
+		std::cerr << name << " " << __func__ << " out of order instruction : " << instrNumber << "\n";
+		assert(0);
+	}
+	tail++;
+}
+
+InstrNum InOrderStage::front() const {
+	if(head == tail) {
+		std::cerr << name << " " << __func__ << " empty pipeline stage\n";
+		assert(0);
+	}
+	return head;
+}
+
+void InOrderStage::pop() {
+	if(head == tail) {
+		std::cerr << name << " " << __func__ << " Pull from empty pipeline stage\n";
+		assert(0);
 	}
-	str << "]";
+	head++;
+}
+
+void InOrderStage::advance(InstrNum numPopped, InstrNum numPushed) {
+	if(head + numPopped > tail + numPushed) {
+		std::cerr << name << " " << __func__ << " Pull from empty pipeline stage\n";
+		assert(0);
+	}
+	head += numPopped;
+	tail += numPushed;
+}
+
+void InOrderStage::print(std::ostream& out) const {
+	out << "[pipeline_stage " << name << " insts " << head << ".." << tail << "]";
+}
+
+std::string InOrderStage::toString() {
+	std::stringstream str;
+	print(str);
 	return str.str();
 }
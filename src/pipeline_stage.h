@@ -1,15 +1,21 @@
 #ifndef SRC_PIPELINE_STAGE_H_
 #define SRC_PIPELINE_STAGE_H_
 
-#include <queue>
+#include <vector>
 
 #include "utils.h"
 #include "instruction.h"
 
+// Queue of in-flight instructions. Backed by a power-of-two ring buffer
+// that only grows, so steady-state push/pop never touch the heap.
 class PipelineStage {
 	std::string name;
 	std::vector<Instruction*> queue;
+	uint32_t head;
+	uint32_t count;
 	uint32_t width;
+
+	void grow();
 public:
 	PipelineStage(std::string name, uint32_t width);
 	virtual ~PipelineStage();
@@ -19,10 +25,51 @@ public:
 	Instruction* front();
 	void pop();
 
-    std::vector<Instruction*>& getAllInstructions() {
-		return queue;
-}
+	uint32_t size() const {
+		return count;
+	}
+
+	// i-th oldest instruction in the stage.
+	Instruction* at(uint32_t i) const {
+		return queue[(head + i) & (queue.size() - 1)];
+	}
+
+	// Removes the i-th oldest instruction, keeping the others in order.
+	void erase(uint32_t i);
+
+	void print(std::ostream& out) const;
+	std::string toString();
+};
+
+/*
+ * Pipeline stage that instructions enter and leave strictly in program
+ * order, so its contents are always a contiguous range of instruction
+ * numbers. Used for the front end, which can back up arbitrarily far
+ * behind a stalled dispatch without needing any storage.
+ */
+class InOrderStage {
+	std::string name;
+	InstrNum head;
+	InstrNum tail;
+public:
+	InOrderStage(std::string name);
+	virtual ~InOrderStage();
+
+	void push(InstrNum instrNumber);
+	bool isEmpty() const {
+		return head == tail;
+	}
+	InstrNum front() const;
+	void pop();
+
+	InstrNum size() const {
+		return tail - head;
+	}
+
+	// Pops numPopped and pushes numPushed instructions at once.
+	void advance(InstrNum numPopped, InstrNum numPushed);
 
+	void print(std::ostream& out) const;
 	std::string toString();
 };
 
@@ -0,0 +1,40 @@
+#ifndef SRC_PROBES_H_
+#define SRC_PROBES_H_
+
+/*
+ * USDT probes on pipeline events, provider r10k, for tracing the simulator
+ * with bpftrace, perf or SystemTap, e.g.
+ *
+ *   bpftrace -e 'usdt:./project3-r10k:r10k:retire { @[arg0 - arg1] = count(); }'
+ *
+ * A probe site is a single nop until a tracer attaches. The Makefile
+ * defines HAVE_SYS_SDT_H when <sys/sdt.h> is installed; without it the
+ * probes compile to nothing. Instruction numbers and cycles are 64-bit,
+ * physical registers are 32-bit with -1 for none.
+ *
+ *   fetch                  (instr, cycle)
+ *   dispatch               (instr, cycle, T, Told, src1, src2)
+ *   issue                  (instr, cycle, src1, src2)
+ *   complete               (instr, cycle, T)
+ *   retire                 (instr, cycle, T, Told)
+ *   stall_rob_full         (instr, cycle)
+ *   stall_rs_busy          (instr, cycle, rsType)
+ *   stall_free_list_empty  (instr, cycle, dstOp)
+ */
+
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+
+#define R10K_PROBE2(name, a1, a2) DTRACE_PROBE2(r10k, name, a1, a2)
+#define R10K_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(r10k, name, a1, a2, a3)
+#define R10K_PROBE4(name, a1, a2, a3, a4) DTRACE_PROBE4(r10k, name, a1, a2, a3, a4)
+#define R10K_PROBE6(name, a1, a2, a3, a4, a5, a6) \
+	DTRACE_PROBE6(r10k, name, a1, a2, a3, a4, a5, a6)
+#else
+#define R10K_PROBE2(name, a1, a2) do {} while(0)
+#define R10K_PROBE3(name, a1, a2, a3) do {} while(0)
+#define R10K_PROBE4(name, a1, a2, a3, a4) do {} while(0)
+#define R10K_PROBE6(name, a1, a2, a3, a4, a5, a6) do {} while(0)
+#endif
+
+#endif /* SRC_PROBES_H_ */
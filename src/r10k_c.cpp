@@ -0,0 +1,243 @@
+#include "r10k_c.h"
+#include <fstream>
+#include <new>
+#include <streambuf>
+
+#include "cpu.h"
+#include "input_file.h"
+
+static_assert(R10K_NUM_STAGES == Stage_COUNT, "R10K_NUM_STAGES out of date");
+static_assert(R10K_CYCLE_UNSET == CYCLE_UNSET, "R10K_CYCLE_UNSET out of date");
+
+struct r10k_sim {
+	CPU cpu;
+
+	r10k_sim(const CPUConfig& config) : cpu(config) {
+	}
+};
+
+// Reads the caller's buffer in place.
+class MemoryBuffer : public std::streambuf {
+public:
+	MemoryBuffer(const char* data, size_t size) {
+		char* begin = const_cast<char*>(data);
+		setg(begin, begin, begin + size);
+	}
+};
+
+static CPUConfig toCPUConfig(const r10k_config* config) {
+	CPUConfig cpuConfig = { config->num_arch_regs, config->num_physical_regs,
+			config->rob_entries, config->width, config->num_lsq_entries };
+	return cpuConfig;
+}
+
+static bool isValid(const CPUConfig& config) {
+	return config.numArchRegs > 0 && config.numPhysicalRegs > config.numArchRegs &&
+			config.robEntries > 0 && config.width > 0;
+}
+
+static int loadTrace(r10k_sim* sim, std::istream& in, r10k_config* configOut) {
+	CPUConfig config;
+	InstructionTrace trace;
+	if(!readInputFile(in, config, trace))
+		return R10K_ERR_PARSE;
+	if(!isValid(config))
+		return R10K_ERR_INVALID;
+	sim->cpu.reset(config);
+	sim->cpu.setTrace(trace);
+	if(configOut) {
+		configOut->num_arch_regs = config.numArchRegs;
+		configOut->num_physical_regs = config.numPhysicalRegs;
+		configOut->rob_entries = config.robEntries;
+		configOut->width = config.width;
+		configOut->num_lsq_entries = config.numLSQEntries;
+	}
+	return R10K_OK;
+}
+
+uint32_t r10k_abi_version(void) {
+	return R10K_ABI_VERSION;
+}
+
+const char* r10k_error_string(int code) {
+	switch(code) {
+	case R10K_OK:
+		return "ok";
+	case R10K_ERR_INVALID:
+		return "invalid argument";
+	case R10K_ERR_IO:
+		return "cannot read file";
+	case R10K_ERR_PARSE:
+		return "malformed input";
+	case R10K_ERR_NO_MEMORY:
+		return "out of memory";
+	}
+	return "unknown error";
+}
+
+r10k_sim* r10k_create(const r10k_config* config) {
+	CPUConfig cpuConfig = { 32, 64, 128, 2, 16 };
+	if(config)
+		cpuConfig = toCPUConfig(config);
+	if(!isValid(cpuConfig))
+		return nullptr;
+	try {
+		return new r10k_sim(cpuConfig);
+	}
+	catch(std::bad_alloc&) {
+		return nullptr;
+	}
+}
+
+void r10k_destroy(r10k_sim* sim) {
+	delete sim;
+}
+
+int r10k_reset(r10k_sim* sim, const r10k_config* config) {
+	if(sim == nullptr)
+		return R10K_ERR_INVALID;
+	try {
+		if(config == nullptr) {
+			sim->cpu.reset();
+			return R10K_OK;
+		}
+		CPUConfig cpuConfig = toCPUConfig(config);
+		if(!isValid(cpuConfig))
+			return R10K_ERR_INVALID;
+		sim->cpu.reset(cpuConfig);
+	}
+	catch(std::bad_alloc&) {
+		return R10K_ERR_NO_MEMORY;
+	}
+	return R10K_OK;
+}
+
+int r10k_load_trace_path(r10k_sim* sim, const char* path, r10k_config* configOut) {
+	if(sim == nullptr || path == nullptr)
+		return R10K_ERR_INVALID;
+	std::ifstream in(path);
+	if(!in.is_open())
+		return R10K_ERR_IO;
+	try {
+		return loadTrace(sim, in, configOut);
+	}
+	catch(std::bad_alloc&) {
+		return R10K_ERR_NO_MEMORY;
+	}
+}
+
+int r10k_load_trace_buffer(r10k_sim* sim, const char* data, size_t size, r10k_config* configOut) {
+	if(sim == nullptr || (data == nullptr && size != 0))
+		return R10K_ERR_INVALID;
+	MemoryBuffer buffer(data, size);
+	std::istream in(&buffer);
+	try {
+		return loadTrace(sim, in, configOut);
+	}
+	catch(std::bad_alloc&) {
+		return R10K_ERR_NO_MEMORY;
+	}
+}
+
+int r10k_add_instructions(r10k_sim* sim, const char* types, const uint32_t* ops, size_t count) {
+	if(sim == nullptr || (count && (types == nullptr || ops == nullptr)) ||
+			sim->cpu.getStats().cycles != 0)
+		return R10K_ERR_INVALID;
+	for(size_t i = 0; i < count; i++)
+		if(!StaticInstruction::isValidType(types[i]))
+			return R10K_ERR_INVALID;
+	try {
+		for(size_t i = 0; i < count; i++)
+			sim->cpu.addInstruction(types[i], ops[3 * i], ops[3 * i + 1], ops[3 * i + 2]);
+	}
+	catch(std::bad_alloc&) {
+		return R10K_ERR_NO_MEMORY;
+	}
+	return R10K_OK;
+}
+
+// The timing history and trace buffer grow as the simulation runs.
+int r10k_run(r10k_sim* sim) {
+	if(sim == nullptr)
+		return R10K_ERR_INVALID;
+	try {
+		sim->cpu.simulate();
+	}
+	catch(std::bad_alloc&) {
+		return R10K_ERR_NO_MEMORY;
+	}
+	return sim->cpu.isFinished() ? R10K_FINISHED : R10K_STUCK;
+}
+
+uint64_t r10k_step(r10k_sim* sim, uint64_t cycles) {
+	if(sim == nullptr)
+		return 0;
+	try {
+		return sim->cpu.step(cycles);
+	}
+	catch(std::bad_alloc&) {
+		return 0;
+	}
+}
+
+int r10k_run_until(r10k_sim* sim, uint64_t instr) {
+	if(sim == nullptr)
+		return R10K_ERR_INVALID;
+	try {
+		return sim->cpu.runUntil(instr) ? 1 : 0;
+	}
+	catch(std::bad_alloc&) {
+		return R10K_ERR_NO_MEMORY;
+	}
+}
+
+void r10k_get_stats(const r10k_sim* sim, r10k_stats* stats) {
+	if(sim == nullptr || stats == nullptr)
+		return;
+	CPUStats cpuStats = sim->cpu.getStats();
+	stats->cycles = cpuStats.cycles;
+	stats->instructions = cpuStats.instructions;
+	stats->fetched = cpuStats.fetched;
+	stats->retired = cpuStats.retired;
+	stats->ipc = cpuStats.getIPC();
+	stats->finished = cpuStats.finished;
+	stats->stuck = cpuStats.stuck;
+}
+
+uint64_t r10k_num_instructions(const r10k_sim* sim) {
+	if(sim == nullptr)
+		return 0;
+	return sim->cpu.getStats().instructions;
+}
+
+static uint64_t clampCount(const r10k_sim* sim, uint64_t first, uint64_t count) {
+	uint64_t size = sim->cpu.getStats().instructions;
+	if(first >= size)
+		return 0;
+	return count < size - first ? count : size - first;
+}
+
+uint64_t r10k_get_timings(const r10k_sim* sim, uint64_t first, uint64_t count, uint64_t* out) {
+	if(sim == nullptr || out == nullptr)
+		return 0;
+	count = clampCount(sim, first, count);
+	const TimingHistory& history = sim->cpu.getHistory();
+	TimingRow row;
+	for(uint64_t i = 0; i < count; i++) {
+		history.getRow(first + i, row);
+		for(int s = 0; s < Stage_COUNT; s++)
+			out[i * Stage_COUNT + s] = row.cycles[s];
+	}
+	return count;
+}
+
+uint64_t r10k_get_stage_timings(const r10k_sim* sim, int stage,
+		uint64_t first, uint64_t count, uint64_t* out) {
+	if(sim == nullptr || out == nullptr || stage < 0 || stage >= Stage_COUNT)
+		return 0;
+	count = clampCount(sim, first, count);
+	const TimingHistory& history = sim->cpu.getHistory();
+	for(uint64_t i = 0; i < count; i++)
+		out[i] = history.getStageCycle(first + i, (TimingStage) stage);
+	return count;
+}
@@ -0,0 +1,125 @@
+#ifndef SRC_R10K_C_H_
+#define SRC_R10K_C_H_
+
+/*
+ * C interface to the simulator, for drivers written in other languages.
+ * Only fixed-width types and opaque handles cross the boundary, so the
+ * layout is stable for ctypes/cffi. Results are written straight into
+ * caller-provided buffers (e.g. a numpy array's data pointer):
+ *
+ *   lib = ctypes.CDLL("./libr10k.so")
+ *   lib.r10k_create.restype = ctypes.c_void_p
+ *   lib.r10k_create.argtypes = [ctypes.c_void_p]
+ *   lib.r10k_load_trace_path.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_void_p]
+ *   lib.r10k_run.argtypes = [ctypes.c_void_p]
+ *   lib.r10k_num_instructions.restype = ctypes.c_uint64
+ *   lib.r10k_num_instructions.argtypes = [ctypes.c_void_p]
+ *   lib.r10k_get_timings.restype = ctypes.c_uint64
+ *   lib.r10k_get_timings.argtypes = [ctypes.c_void_p, ctypes.c_uint64, ctypes.c_uint64,
+ *           ctypes.c_void_p]
+ *   lib.r10k_destroy.argtypes = [ctypes.c_void_p]
+ *
+ *   sim = lib.r10k_create(None)
+ *   lib.r10k_load_trace_path(sim, b"inputs/ex1.txt", None)
+ *   lib.r10k_run(sim)
+ *   n = lib.r10k_num_instructions(sim)
+ *   rows = numpy.empty((n, R10K_NUM_STAGES), dtype=numpy.uint64)
+ *   lib.r10k_get_timings(sim, 0, n, rows.ctypes.data)
+ *   lib.r10k_destroy(sim)
+ *
+ * Without restype and argtypes, ctypes passes and returns every argument
+ * as a C int, truncating the handle and the 64-bit counts.
+ *
+ * Functions returning int return R10K_OK or a negative R10K_ERR_* code.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define R10K_ABI_VERSION 1
+
+// Number of timestamps per instruction: fetch, decode, dispatch, issue,
+// execute, complete and retire, in that order.
+#define R10K_NUM_STAGES 7
+// Timestamp of a stage the instruction never reached.
+#define R10K_CYCLE_UNSET UINT64_MAX
+
+#define R10K_OK 0
+#define R10K_ERR_INVALID -1
+#define R10K_ERR_IO -2
+#define R10K_ERR_PARSE -3
+#define R10K_ERR_NO_MEMORY -4
+
+// r10k_run() results.
+#define R10K_FINISHED 0
+#define R10K_STUCK 1
+
+typedef struct r10k_sim r10k_sim;
+
+typedef struct {
+	uint32_t num_arch_regs;
+	uint32_t num_physical_regs;
+	uint32_t rob_entries;
+	uint32_t width;
+	uint32_t num_lsq_entries;
+} r10k_config;
+
+typedef struct {
+	uint64_t cycles;
+	uint64_t instructions;
+	uint64_t fetched;
+	uint64_t retired;
+	double ipc;
+	int32_t finished;
+	int32_t stuck;
+} r10k_stats;
+
+uint32_t r10k_abi_version(void);
+const char* r10k_error_string(int code);
+
+// A NULL config gives the 32/64/128/2/16 machine of the sample inputs;
+// loading an input file replaces it with the file's configuration.
+r10k_sim* r10k_create(const r10k_config* config);
+void r10k_destroy(r10k_sim* sim);
+
+// Restarts the loaded trace from cycle 0 on config, or on the current
+// configuration if config is NULL.
+int r10k_reset(r10k_sim* sim, const r10k_config* config);
+
+// Load an input file (configuration line plus instructions), from a path
+// or from memory. Replaces the trace, resets the simulator to the file's
+// configuration and, if config_out is not NULL, stores it there.
+int r10k_load_trace_path(r10k_sim* sim, const char* path, r10k_config* config_out);
+int r10k_load_trace_buffer(r10k_sim* sim, const char* data, size_t size, r10k_config* config_out);
+
+// Appends instructions in input-file encoding; ops holds srcOp1, srcOp2
+// and dstOp of each instruction. Only valid before the run starts.
+int r10k_add_instructions(r10k_sim* sim, const char* types, const uint32_t* ops, size_t count);
+
+// r10k_run() returns R10K_FINISHED or R10K_STUCK; r10k_step() the number
+// of cycles simulated; r10k_run_until() 1 once instr has retired, else 0.
+// Running out of memory gives R10K_ERR_NO_MEMORY, or 0 from r10k_step(),
+// and leaves the simulator to be reset.
+int r10k_run(r10k_sim* sim);
+uint64_t r10k_step(r10k_sim* sim, uint64_t cycles);
+int r10k_run_until(r10k_sim* sim, uint64_t instr);
+
+void r10k_get_stats(const r10k_sim* sim, r10k_stats* stats);
+uint64_t r10k_num_instructions(const r10k_sim* sim);
+
+// Copy the timestamps of instructions [first, first + count) to out,
+// row-major with R10K_NUM_STAGES entries per instruction, or one stage as
+// a column. Return the number of instructions copied.
+uint64_t r10k_get_timings(const r10k_sim* sim, uint64_t first, uint64_t count, uint64_t* out);
+uint64_t r10k_get_stage_timings(const r10k_sim* sim, int stage,
+		uint64_t first, uint64_t count, uint64_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_R10K_C_H_ */
@@ -0,0 +1,66 @@
+#include "register_hot_spots.h"
+
+#include <algorithm>
+#include <iomanip>
+
+RegisterHotSpots::RegisterHotSpots() {
+}
+
+RegisterHotSpots::~RegisterHotSpots() {
+}
+
+RegisterHotSpots::Entry& RegisterHotSpots::get(uint32_t archReg) {
+	if(archReg >= registers.size())
+		registers.resize(archReg + 1, Entry { 0, 0, 0 });
+	return registers[archReg];
+}
+
+void RegisterHotSpots::clear() {
+	registers.clear();
+}
+
+void RegisterHotSpots::addIssueWait(uint32_t archReg, Cycle numCycles) {
+	Entry& entry = get(archReg);
+	entry.issueWaitCycles += numCycles;
+	entry.numWaiting++;
+}
+
+void RegisterHotSpots::addFreeListStall(uint32_t archReg) {
+	get(archReg).freeListStalls++;
+}
+
+void RegisterHotSpots::write(std::ostream& out, size_t maxRows) const {
+	std::vector<uint32_t> ranked;
+	uint64_t total = 0;
+	for(uint32_t r = 0; r < registers.size(); r++) {
+		uint64_t cycles = registers[r].issueWaitCycles + registers[r].freeListStalls;
+		if(cycles == 0)
+			continue;
+		ranked.push_back(r);
+		total += cycles;
+	}
+	std::stable_sort(ranked.begin(), ranked.end(), [this](uint32_t a, uint32_t b) {
+		return registers[a].issueWaitCycles + registers[a].freeListStalls >
+				registers[b].issueWaitCycles + registers[b].freeListStalls;
+	});
+	if(maxRows != 0 && ranked.size() > maxRows)
+		ranked.resize(maxRows);
+
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	out << std::fixed << std::setprecision(1);
+	out << std::setw(6) << "reg" << std::setw(16) << "issue wait" << std::setw(12) << "waiting" <<
+			std::setw(10) << "mean" << std::setw(18) << "free list stalls" << std::setw(9) <<
+			"share" << "\n";
+	for(uint32_t r : ranked) {
+		const Entry& entry = registers[r];
+		uint64_t cycles = entry.issueWaitCycles + entry.freeListStalls;
+		out << std::setw(6) << ("r" + std::to_string(r)) << std::setw(16) << entry.issueWaitCycles <<
+				std::setw(12) << entry.numWaiting << std::setw(10) <<
+				(entry.numWaiting ? (double) entry.issueWaitCycles / entry.numWaiting : 0) <<
+				std::setw(18) << entry.freeListStalls << std::setw(8) << 100.0 * cycles / total <<
+				"%\n";
+	}
+	out.flags(flags);
+	out.precision(precision);
+}
@@ -0,0 +1,47 @@
+#ifndef SRC_REGISTER_HOT_SPOTS_H_
+#define SRC_REGISTER_HOT_SPOTS_H_
+
+#include <ostream>
+#include <vector>
+
+#include "utils.h"
+
+/*
+ * Waiting caused by each architectural register (see
+ * BasicCPU::setRegisterHotSpots()). Cycles an instruction spent in its
+ * reservation station before its last operand was ready go to that
+ * operand's register; cycles dispatch stalled on an empty free list go to
+ * the destination register of the instruction it held back.
+ */
+class RegisterHotSpots {
+	struct Entry {
+		uint64_t issueWaitCycles;
+		// Instructions that waited on the register at all.
+		uint64_t numWaiting;
+		uint64_t freeListStalls;
+	};
+	std::vector<Entry> registers;
+
+	Entry& get(uint32_t archReg);
+public:
+	RegisterHotSpots();
+	virtual ~RegisterHotSpots();
+
+	void clear();
+	void addIssueWait(uint32_t archReg, Cycle numCycles);
+	void addFreeListStall(uint32_t archReg);
+
+	uint64_t getIssueWaitCycles(uint32_t archReg) const {
+		return archReg < registers.size() ? registers[archReg].issueWaitCycles : 0;
+	}
+
+	uint64_t getFreeListStalls(uint32_t archReg) const {
+		return archReg < registers.size() ? registers[archReg].freeListStalls : 0;
+	}
+
+	// Registers ranked by the cycles they account for, at most maxRows of
+	// them unless maxRows is 0.
+	void write(std::ostream& out, size_t maxRows = 0) const;
+};
+
+#endif /* SRC_REGISTER_HOT_SPOTS_H_ */
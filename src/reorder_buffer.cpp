@@ -43,12 +43,17 @@ ROBEntry* ReorderBuffer::getHead() {
 	return &(rob[head]);
 }
 
-std::string ReorderBuffer::toString() {
-	std::stringstream str;
-	str << "[ROB: h=" << head << " t=" << tail << " ";
+void ReorderBuffer::print(std::ostream& out) const {
+	out << "[ROB: h=" << head << " t=" << tail << " ";
 	for(int i = head; i != tail; i++, i %= robEntries) {
-		str << "\n\t" << rob[i].toString();
+		out << "\n\t";
+		rob[i].print(out);
 	}
-	str << "]";
+	out << "]";
+}
+
+std::string ReorderBuffer::toString() {
+	std::stringstream str;
+	print(str);
 	return str.str();
 }
@@ -33,10 +33,21 @@ public:
 		this->told = told;
 	}
 
+	void print(std::ostream& out) const {
+		if(inst != nullptr) {
+			out << "[";
+			inst->print(out);
+			out << " T=";
+			t.print(out);
+			out << " Told=";
+			told.print(out);
+			out << "]";
+		}
+	}
+
 	std::string toString() {
 		std::stringstream str;
-		if(inst != nullptr)
-			str << "[" << inst->toString() << " T=" << t.toString() << " Told=" << told.toString() << "]";
+		print(str);
 		return str.str();
 	}
 
@@ -65,6 +76,18 @@ public:
 
 	ROBEntry* getHead();
 
+	uint32_t size() const {
+		if(full)
+			return robEntries;
+		return (tail + robEntries - head) % robEntries;
+	}
+
+	// i-th oldest entry.
+	ROBEntry& at(uint32_t i) {
+		return rob[(head + i) % robEntries];
+	}
+
+	void print(std::ostream& out) const;
 	std::string toString();
 };
 
@@ -38,12 +38,15 @@ void ReservationStation::broadcastRegReady(uint32_t physicalRegNum) {
 		inst->getSrcPhysicalReg2().setReady(true);
 }
 
+void ReservationStation::print(std::ostream& out) const {
+	out << "[" << name << " busy=" << busy << " ";
+	if(inst)
+		inst->print(out);
+	out << "]";
+}
+
 std::string ReservationStation::toString() {
 	std::stringstream str;
-	str << "[" << name << " busy=" << busy << " ";
-	if(inst)
-		str << inst->toString() << "]";
-	else
-		str << "]";
+	print(str);
 	return str.str();
 }
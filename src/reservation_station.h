@@ -21,6 +21,10 @@ public:
 
 	void broadcastRegReady(uint32_t physicalRegNum);
 
+	const std::string& getName() const {
+		return name;
+	}
+
 	bool isBusy() const {
 		return busy;
 	}
@@ -49,6 +53,7 @@ public:
 		return execTime;
 	}
 
+	void print(std::ostream& out) const;
 	std::string toString();
 };
 
@@ -0,0 +1,153 @@
+#include "slack_stats.h"
+
+#include <algorithm>
+#include <iomanip>
+
+SlackStats::SlackStats(const CPUConfig& config) :
+	lastRetire(0), numArchRegs(0), robEntries(config.robEntries), width(config.width),
+	numFreeRegisters(config.numPhysicalRegs - config.numArchRegs), numStations(0) {
+}
+
+SlackStats::~SlackStats() {
+}
+
+void SlackStats::clear() {
+	entries.clear();
+	lastRetire = 0;
+	numArchRegs = 0;
+	numStations = 0;
+}
+
+void SlackStats::add(char type, uint32_t srcOp1, uint32_t srcOp2, uint32_t dstOp, uint8_t rs,
+		const TimingRow& row) {
+	const Cycle* cycles = row.cycles;
+	entries.push_back(Entry { cycles[Stage_COMPLETE],
+			(uint32_t) (cycles[Stage_ISSUE] - cycles[Stage_DISPATCH]),
+			(uint32_t) (cycles[Stage_EXECUTE] - cycles[Stage_ISSUE]),
+			(uint32_t) (cycles[Stage_COMPLETE] - cycles[Stage_EXECUTE]),
+			(uint32_t) (cycles[Stage_RETIRE] - cycles[Stage_COMPLETE]),
+			srcOp1, srcOp2, dstOp, type, rs });
+	lastRetire = std::max(lastRetire, cycles[Stage_RETIRE]);
+	numStations = std::max<uint32_t>(numStations, rs + 1);
+	uint32_t ops[3] = { srcOp1, srcOp2, dstOp };
+	for(uint32_t op : ops)
+		if(op != -1)
+			numArchRegs = std::max(numArchRegs, op + 1);
+}
+
+void SlackStats::getSlack(std::vector<Cycle>& slack, std::vector<Cycle>& localSlack) const {
+	size_t numEntries = entries.size();
+	slack.resize(numEntries);
+	localSlack.resize(numEntries);
+	if(numEntries == 0)
+		return;
+	// Instructions with a result, each of which takes a physical register
+	// and frees one when it retires. The one numFreeRegisters later waits
+	// for it.
+	std::vector<size_t> writers;
+	for(size_t i = 0; i < numEntries; i++)
+		if(entries[i].dstOp != -1)
+			writers.push_back(i);
+	size_t writer = writers.size();
+
+	// The cycle by which the value in each register is needed, by the
+	// consumers after the current instruction and before its next writer,
+	// at the latest and as they actually issued; and the same for the
+	// dispatch of the next instruction to use each reservation station.
+	std::vector<Cycle> need(numArchRegs, UINT64_MAX);
+	std::vector<Cycle> used(numArchRegs, UINT64_MAX);
+	std::vector<Cycle> stationNeeded(numStations, UINT64_MAX);
+	std::vector<Cycle> stationUsed(numStations, UINT64_MAX);
+	std::vector<Cycle> latestRetire(numEntries);
+	std::vector<Cycle> latestDispatch(numEntries);
+	for(size_t i = numEntries; i-- > 0;) {
+		const Entry& entry = entries[i];
+		// Within a cycle, retire comes first, so a RoB entry it frees can
+		// be dispatched into in the same cycle, while a physical register
+		// only joins the free list the cycle after. Then come complete,
+		// execute, which frees the reservation station before dispatch,
+		// issue and dispatch.
+		Cycle retire = i + 1 < numEntries ? latestRetire[i + 1] : lastRetire;
+		if(i + width < numEntries)
+			retire = std::min(retire, latestRetire[i + width] - 1);
+		if(i + robEntries < numEntries)
+			retire = std::min(retire, latestDispatch[i + robEntries]);
+		if(entry.dstOp != -1 && --writer + numFreeRegisters < writers.size())
+			retire = std::min(retire, latestDispatch[writers[writer + numFreeRegisters]] - 1);
+		latestRetire[i] = retire;
+
+		Cycle latest = retire - 1;
+		Cycle local = entry.complete + entry.retireWait - 1;
+		if(stationNeeded[entry.rs] != UINT64_MAX) {
+			latest = std::min(latest, stationNeeded[entry.rs] + entry.executeTime);
+			local = std::min(local, stationUsed[entry.rs] + entry.executeTime);
+		}
+		if(entry.dstOp != -1) {
+			latest = std::min(latest, need[entry.dstOp]);
+			local = std::min(local, used[entry.dstOp]);
+			// Older instructions read the value of an older writer.
+			need[entry.dstOp] = UINT64_MAX;
+			used[entry.dstOp] = UINT64_MAX;
+		}
+		Cycle latestIssue = latest - entry.executeTime - entry.issueWait;
+		Cycle issue = entry.complete - entry.executeTime - entry.issueWait;
+		uint32_t ops[2] = { entry.srcOp1, entry.srcOp2 };
+		for(uint32_t op : ops) {
+			if(op == -1)
+				continue;
+			need[op] = std::min(need[op], latestIssue);
+			used[op] = std::min(used[op], issue);
+		}
+
+		Cycle dispatch = latestIssue - entry.dispatchWait;
+		if(i + 1 < numEntries)
+			dispatch = std::min(dispatch, latestDispatch[i + 1]);
+		if(i + width < numEntries)
+			dispatch = std::min(dispatch, latestDispatch[i + width] - 1);
+		latestDispatch[i] = dispatch;
+		stationNeeded[entry.rs] = dispatch;
+		stationUsed[entry.rs] = issue - entry.dispatchWait;
+
+		slack[i] = latest > entry.complete ? latest - entry.complete : 0;
+		localSlack[i] = local > entry.complete ? local - entry.complete : 0;
+	}
+}
+
+void SlackStats::write(std::ostream& out, bool withBuckets) const {
+	std::vector<Cycle> slack, localSlack;
+	getSlack(slack, localSlack);
+	Histogram histograms[NUM_INSTR_TYPES];
+	Histogram local[NUM_INSTR_TYPES];
+	uint64_t numCritical[NUM_INSTR_TYPES] = {};
+	for(size_t i = 0; i < entries.size(); i++) {
+		int t = getInstrTypeIndex(entries[i].type);
+		histograms[t].add(slack[i]);
+		local[t].add(localSlack[i]);
+		if(slack[i] == 0)
+			numCritical[t]++;
+	}
+
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	out << std::fixed << std::setprecision(2);
+	out << std::left << std::setw(6) << "type" << std::right << std::setw(12) << "count" <<
+			std::setw(10) << "no slack" << std::setw(10) << "mean" << std::setw(8) << "p10" <<
+			std::setw(8) << "p50" << std::setw(8) << "p90" << std::setw(10) << "max" << std::setw(12) << "local mean" <<
+			std::setw(10) << "local p50" << "\n";
+	for(int t = 0; t < NUM_INSTR_TYPES; t++) {
+		const Histogram& histogram = histograms[t];
+		if(histogram.getCount() == 0)
+			continue;
+		out << std::left << std::setw(6) << getInstrType(t) << std::right << std::setw(12) <<
+				histogram.getCount() << std::setw(9) <<
+				100.0 * numCritical[t] / histogram.getCount() << "%" << std::setw(10) <<
+				histogram.getMean() << std::setw(8) << histogram.getPercentile(0.1) <<
+				std::setw(8) << histogram.getPercentile(0.5) << std::setw(8) <<
+				histogram.getPercentile(0.9) << std::setw(10) << histogram.getMax() << std::setw(12) <<
+				local[t].getMean() << std::setw(10) << local[t].getPercentile(0.5) << "\n";
+		if(withBuckets)
+			histogram.write(out, "      ");
+	}
+	out.flags(flags);
+	out.precision(precision);
+}
@@ -0,0 +1,92 @@
+#ifndef SRC_SLACK_STATS_H_
+#define SRC_SLACK_STATS_H_
+
+#include <ostream>
+#include <vector>
+
+#include "cpu_config.h"
+#include "histogram.h"
+#include "timing_file.h"
+#include "utils.h"
+
+/*
+ * Slack of every instruction: the cycles its completion could have been
+ * delayed without delaying the retirement of the last instruction,
+ * gathered as instructions retire (see BasicCPU::setSlackStats()).
+ *
+ * One reverse pass over the recorded instructions works out the latest
+ * cycle each could have completed in, every instruction taking as long as
+ * it did from dispatch to issue, to execute and to complete. It is bound
+ * by:
+ *
+ *  - its latest retire, which is no later than that of the next
+ *    instruction, as retirement is in order, before that of the
+ *    instruction width later, as width retire per cycle, and early enough
+ *    for the instructions waiting on the RoB entry and the physical
+ *    register it frees to dispatch in time;
+ *  - the latest dispatch of the next instruction to use its reservation
+ *    station, which it frees when it executes. Dispatch is in order and
+ *    width wide as well, and comes before issue;
+ *  - the latest issue of every instruction that reads its result.
+ *
+ * Instructions without a result, such as stores, are bound by the first
+ * two alone. Slack is zero on the critical path, and shows how far the
+ * latency of each unit class could grow before the total cycles do. As
+ * the structures are only held to their capacity and the order in which
+ * they were used, it is an upper bound.
+ *
+ * Local slack is what is left without delaying any other instruction as
+ * it was: its consumers' issue, its reservation station's next dispatch,
+ * and its own retirement.
+ *
+ * Keeps about 40 bytes per retired instruction until write(), which
+ * needs another 24.
+ */
+class SlackStats {
+	struct Entry {
+		Cycle complete;
+		// Cycles from dispatch to issue, issue to execute, execute to
+		// complete and complete to retire.
+		uint32_t dispatchWait;
+		uint32_t issueWait;
+		uint32_t executeTime;
+		uint32_t retireWait;
+		// Architectural registers, -1 if unused.
+		uint32_t srcOp1;
+		uint32_t srcOp2;
+		uint32_t dstOp;
+		char type;
+		uint8_t rs;
+	};
+	std::vector<Entry> entries;
+	Cycle lastRetire;
+	uint32_t numArchRegs;
+	uint32_t robEntries;
+	uint32_t width;
+	// Physical registers free when the simulation starts.
+	uint32_t numFreeRegisters;
+	uint32_t numStations;
+public:
+	// config must be that of the CPU simulated.
+	SlackStats(const CPUConfig& config);
+	virtual ~SlackStats();
+
+	void clear();
+	// Makes room for numInstructions in all.
+	void reserve(InstrNum numInstructions) {
+		entries.reserve(numInstructions);
+	}
+	// Adds the next instruction to retire, in program order, with the
+	// reservation station it used and its timing.
+	void add(char type, uint32_t srcOp1, uint32_t srcOp2, uint32_t dstOp, uint8_t rs,
+			const TimingRow& row);
+
+	// The slack and local slack of every instruction added, in order.
+	void getSlack(std::vector<Cycle>& slack, std::vector<Cycle>& localSlack) const;
+
+	// Slack distribution per instruction type, with the buckets of every
+	// histogram if withBuckets.
+	void write(std::ostream& out, bool withBuckets) const;
+};
+
+#endif /* SRC_SLACK_STATS_H_ */
@@ -0,0 +1,84 @@
+#include "stats_page.h"
+
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Size of the stats file: one page.
+#define STATS_PAGE_SIZE 4096
+
+static_assert(sizeof(StatsPageData) <= STATS_PAGE_SIZE, "StatsPageData must fit in a page");
+
+uint64_t getHostNanos() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+StatsPage::StatsPage() :
+	data(nullptr) {
+}
+
+StatsPage::~StatsPage() {
+	close();
+}
+
+bool StatsPage::open(std::string path, const CPUConfig& config) {
+	close();
+	int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0 || ftruncate(fd, STATS_PAGE_SIZE) != 0) {
+		std::cerr << "Cannot create " << path << "\n";
+		if(fd >= 0)
+			::close(fd);
+		return false;
+	}
+	void* map = mmap(nullptr, STATS_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if(map == MAP_FAILED) {
+		std::cerr << "Cannot map " << path << "\n";
+		return false;
+	}
+	this->path = path;
+	// The file was just truncated, so every field starts out as zero.
+	data = new(map) StatsPageData();
+	data->version = STATS_PAGE_VERSION;
+	data->pid = getpid();
+	data->config[0] = config.numArchRegs;
+	data->config[1] = config.numPhysicalRegs;
+	data->config[2] = config.robEntries;
+	data->config[3] = config.width;
+	data->config[4] = config.numLSQEntries;
+	uint64_t now = getHostNanos();
+	data->hostStartNanos.store(now, std::memory_order_relaxed);
+	data->hostNanos.store(now, std::memory_order_relaxed);
+	// Written last, so that monitors only accept a filled-in header.
+	std::atomic_thread_fence(std::memory_order_release);
+	memcpy(data->magic, STATS_PAGE_MAGIC, sizeof(data->magic));
+	return true;
+}
+
+void StatsPage::close() {
+	if(data == nullptr)
+		return;
+	munmap(data, STATS_PAGE_SIZE);
+	data = nullptr;
+}
+
+void StatsPage::update(Cycle cycle, InstrNum retired, InstrNum fetched, InstrNum instructions,
+		uint32_t robOccupancy, uint32_t freeRegisters, bool finished) {
+	if(data == nullptr)
+		return;
+	std::memory_order relaxed = std::memory_order_relaxed;
+	data->cycle.store(cycle, relaxed);
+	data->retired.store(retired, relaxed);
+	data->fetched.store(fetched, relaxed);
+	data->instructions.store(instructions, relaxed);
+	data->robOccupancy.store(robOccupancy, relaxed);
+	data->freeRegisters.store(freeRegisters, relaxed);
+	data->hostNanos.store(getHostNanos(), relaxed);
+	data->finished.store(finished, relaxed);
+	data->updates.fetch_add(1, relaxed);
+}
@@ -0,0 +1,82 @@
+#ifndef SRC_STATS_PAGE_H_
+#define SRC_STATS_PAGE_H_
+
+#include <atomic>
+#include <string>
+
+#include "cpu_config.h"
+#include "utils.h"
+
+#define STATS_PAGE_MAGIC "R10KSTAT"
+#define STATS_PAGE_VERSION 1
+// Cycles between updates unless told otherwise.
+#define STATS_PAGE_DEFAULT_INTERVAL (1 << 16)
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the stats page needs lock-free 64-bit atomics");
+
+/*
+ * Layout of a stats file, shared between the simulator and monitors that
+ * map it. Counters are written with relaxed atomics, so a reader may see
+ * them from slightly different cycles. Host times are CLOCK_MONOTONIC
+ * nanoseconds, comparable between processes.
+ */
+struct StatsPageData {
+	char magic[8];
+	uint32_t version;
+	uint32_t pid;
+	uint32_t config[5];
+	uint32_t reserved;
+	std::atomic<uint64_t> cycle;
+	std::atomic<uint64_t> retired;
+	std::atomic<uint64_t> fetched;
+	// Length of the trace, 0 until it is known.
+	std::atomic<uint64_t> instructions;
+	std::atomic<uint64_t> robOccupancy;
+	std::atomic<uint64_t> freeRegisters;
+	std::atomic<uint64_t> hostStartNanos;
+	std::atomic<uint64_t> hostNanos;
+	// Incremented by every update.
+	std::atomic<uint64_t> updates;
+	std::atomic<uint32_t> finished;
+	// Set by a monitor or a signal handler; the simulator writes a state
+	// snapshot at its next update and clears it.
+	std::atomic<uint32_t> snapshotRequested;
+};
+
+// The simulator's side of a stats file.
+class StatsPage {
+	StatsPageData* data;
+	std::string path;
+public:
+	StatsPage();
+	virtual ~StatsPage();
+	StatsPage(const StatsPage&) = delete;
+	StatsPage& operator=(const StatsPage&) = delete;
+
+	bool open(std::string path, const CPUConfig& config);
+	void close();
+
+	void update(Cycle cycle, InstrNum retired, InstrNum fetched, InstrNum instructions,
+			uint32_t robOccupancy, uint32_t freeRegisters, bool finished);
+
+	// Safe to call from a signal handler.
+	void requestSnapshot() {
+		if(data)
+			data->snapshotRequested.store(1, std::memory_order_relaxed);
+	}
+
+	// Returns true, once, after a snapshot was requested.
+	bool takeSnapshotRequest() {
+		return data && data->snapshotRequested.exchange(0, std::memory_order_relaxed);
+	}
+
+	// Where snapshots go: the stats file's path with ".state" appended.
+	std::string getSnapshotPath() const {
+		return path + ".state";
+	}
+};
+
+// Current CLOCK_MONOTONIC time.
+uint64_t getHostNanos();
+
+#endif /* SRC_STATS_PAGE_H_ */
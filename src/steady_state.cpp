@@ -0,0 +1,99 @@
+#include "steady_state.h"
+
+SteadyStateDetector::SteadyStateDetector() :
+	hasReference(false), power(1), steps(0), keyStamp(0), nextLabel(0),
+	firstRecorded(0), numRecorded(0) {
+	referencePoint = SteadyStatePoint { 0, 0, 0 };
+	referencePoint.counters.clear();
+}
+
+SteadyStateDetector::~SteadyStateDetector() {
+}
+
+void SteadyStateDetector::reset(uint32_t numPhysicalRegs) {
+	key.clear();
+	reference.clear();
+	hasReference = false;
+	power = 1;
+	steps = 0;
+	labels.assign(numPhysicalRegs, 0);
+	labelStamps.assign(numPhysicalRegs, 0);
+	keyStamp = 0;
+	dispatched.resize(STEADY_STATE_MAX_PERIOD_INSTRUCTIONS);
+	firstRecorded = 0;
+	numRecorded = 0;
+}
+
+void SteadyStateDetector::beginKey() {
+	key.clear();
+	nextLabel = 0;
+	keyStamp++;
+	// Stamps wrapped around: old labels might look current.
+	if(keyStamp == 0) {
+		labelStamps.assign(labelStamps.size(), 0);
+		keyStamp = 1;
+	}
+}
+
+void SteadyStateDetector::addRegister(const PhysicalRegister& reg, bool withReadyBit) {
+	uint32_t regNum = reg.getRegNum();
+	// Nothing reads the ready bit of a missing operand.
+	if(regNum == -1) {
+		add(UINT32_MAX);
+		return;
+	}
+	if(labelStamps[regNum] != keyStamp) {
+		labelStamps[regNum] = keyStamp;
+		labels[regNum] = nextLabel++;
+	}
+	uint64_t word = labels[regNum];
+	if(withReadyBit && reg.isReady())
+		word |= (uint64_t) 1 << 32;
+	add(word);
+}
+
+bool SteadyStateDetector::endKey(const SteadyStatePoint& point, SteadyStatePoint& previous) {
+	if(hasReference && key == reference) {
+		previous = referencePoint;
+		return true;
+	}
+	steps++;
+	if(!hasReference || steps >= power) {
+		reference.swap(key);
+		referencePoint = point;
+		hasReference = true;
+		steps = 0;
+		if(power < STEADY_STATE_MAX_PERIOD)
+			power *= 2;
+	}
+	return false;
+}
+
+void SteadyStateDetector::restart(const SteadyStatePoint& point) {
+	reference.swap(key);
+	referencePoint = point;
+	hasReference = true;
+	power = 1;
+	steps = 0;
+}
+
+void SteadyStateDetector::shiftReference(InstrNum numInstructions, Cycle numCycles,
+		const PipelineCounters& counters) {
+	referencePoint.cycle += numCycles;
+	referencePoint.counters.add(counters);
+	referencePoint.dispatched += numInstructions;
+	referencePoint.retired += numInstructions;
+}
+
+void SteadyStateDetector::recordDispatch(InstrNum instrNumber, const StaticInstruction& inst) {
+	// Skipped instructions were never recorded.
+	if(instrNumber != numRecorded)
+		firstRecorded = instrNumber;
+	dispatched[instrNumber & (dispatched.size() - 1)] = inst;
+	numRecorded = instrNumber + 1;
+}
+
+bool SteadyStateDetector::hasRecorded(InstrNum first, InstrNum count) const {
+	return first >= firstRecorded && first + count <= numRecorded &&
+			numRecorded - first <= dispatched.size();
+}
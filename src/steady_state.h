@@ -0,0 +1,104 @@
+#ifndef SRC_STEADY_STATE_H_
+#define SRC_STEADY_STATE_H_
+
+#include <vector>
+
+#include "instruction_trace.h"
+#include "physical_register.h"
+#include "pipeline_counters.h"
+#include "utils.h"
+
+// Longest period, in cycles, the detector looks for.
+#define STEADY_STATE_MAX_PERIOD (1 << 16)
+// Dispatched instructions kept to check that the trace repeats, which also
+// bounds the period in instructions. A power of two.
+#define STEADY_STATE_MAX_PERIOD_INSTRUCTIONS (1 << 16)
+
+// Where the pipeline was when its state was described.
+struct SteadyStatePoint {
+	Cycle cycle;
+	// Next instruction to dispatch.
+	InstrNum dispatched;
+	InstrNum retired;
+	PipelineCounters counters;
+};
+
+/*
+ * Notices when the pipeline gets back into a state it was in before, up to
+ * renaming: physical registers are numbered in order of first appearance,
+ * instructions relative to the next one to dispatch and timestamps
+ * relative to the current cycle. If the trace also repeats from there on,
+ * so does the timing, which lets BasicCPU skip whole periods (see
+ * BasicCPU::setExtrapolation()).
+ *
+ * The CPU describes its state as a key of 64-bit words every cycle, between
+ * beginKey() and endKey(). Repeats are found with Brent's cycle detection,
+ * so only one earlier key is kept and comparing keys is all it costs.
+ */
+class SteadyStateDetector {
+	std::vector<uint64_t> key;
+	std::vector<uint64_t> reference;
+	SteadyStatePoint referencePoint;
+	bool hasReference;
+	// The reference is replaced after power more keys; power doubles up to
+	// STEADY_STATE_MAX_PERIOD each time.
+	Cycle power;
+	Cycle steps;
+
+	// Label of every physical register in the current key, valid while its
+	// stamp equals keyStamp.
+	std::vector<uint32_t> labels;
+	std::vector<uint32_t> labelStamps;
+	uint32_t keyStamp;
+	uint32_t nextLabel;
+
+	// Dispatched instruction n is kept at dispatched[n % size] for
+	// firstRecorded <= n < numRecorded.
+	std::vector<StaticInstruction> dispatched;
+	InstrNum firstRecorded;
+	InstrNum numRecorded;
+public:
+	SteadyStateDetector();
+	virtual ~SteadyStateDetector();
+
+	// Forgets every state and instruction seen so far.
+	void reset(uint32_t numPhysicalRegs);
+
+	void beginKey();
+
+	void add(uint64_t word) {
+		key.push_back(word);
+	}
+
+	// Adds the label of reg, and its ready bit if the pipeline reads it
+	// there.
+	void addRegister(const PhysicalRegister& reg, bool withReadyBit);
+
+	// Completes the key of the state at point. Returns true if an earlier
+	// state, returned in previous, had the same key.
+	bool endKey(const SteadyStatePoint& point, SteadyStatePoint& previous);
+	// Looks for repeats from the last key on only, e.g. once the trace
+	// stopped repeating.
+	void restart(const SteadyStatePoint& point);
+	// Moves the earlier state along after the CPU skipped ahead, so that it
+	// still lies one period back.
+	void shiftReference(InstrNum numInstructions, Cycle numCycles,
+			const PipelineCounters& counters);
+
+	void recordDispatch(InstrNum instrNumber, const StaticInstruction& inst);
+	// Were instructions [first, first + count) all dispatched recently?
+	bool hasRecorded(InstrNum first, InstrNum count) const;
+
+	const StaticInstruction& getRecorded(InstrNum instrNumber) const {
+		return dispatched[instrNumber & (dispatched.size() - 1)];
+	}
+
+	// Compares what the timing depends on, which leaves out immediates, so
+	// that loops walking through memory still repeat.
+	static bool sameTiming(const StaticInstruction& a, const StaticInstruction& b) {
+		return a.type == b.type && a.srcOp1 == b.srcOp1 &&
+				a.srcOp2 == b.srcOp2 && a.dstOp == b.dstOp;
+	}
+};
+
+#endif /* SRC_STEADY_STATE_H_ */
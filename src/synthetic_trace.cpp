@@ -0,0 +1,116 @@
+#include "synthetic_trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define NUM_DISTANCE_QUANTILES 4096
+#define NUM_RECENT_STORES 8
+
+static uint64_t probabilityThreshold(double p) {
+	return p >= 1 ? 1ULL << 53 : (uint64_t) (p * (1ULL << 53));
+}
+
+static const char mixTypes[4] = {
+	InstrType_REG, InstrType_IMM, InstrType_LOAD, InstrType_STORE
+};
+
+SyntheticTraceParams::SyntheticTraceParams() :
+	length(0), numArchRegs(32), meanDependencyDistance(0),
+	registerReuse(0), reuseWindow(8), aliasRate(0), seed(1) {
+	for(int i = 0; i < 4; i++)
+		mix[i] = 1;
+}
+
+SyntheticTraceSource::SyntheticTraceSource(const SyntheticTraceParams& params) :
+	params(params) {
+	assert(params.numArchRegs > 0);
+	assert(params.reuseWindow > 0 && params.reuseWindow < SYNTHETIC_MAX_DEPENDENCY_DISTANCE);
+	double total = 0;
+	for(int i = 0; i < 4; i++)
+		total += params.mix[i];
+	assert(total > 0);
+	double sum = 0;
+	for(int i = 0; i < 4; i++) {
+		sum += params.mix[i];
+		mixThresholds[i] = probabilityThreshold(sum / total);
+	}
+	reuseThreshold = probabilityThreshold(params.registerReuse);
+	aliasThreshold = probabilityThreshold(params.aliasRate);
+	// Inverse CDF of the geometric distribution with the requested mean.
+	double p = params.meanDependencyDistance >= 1 ? 1 / params.meanDependencyDistance : 1;
+	for(int i = 0; i < NUM_DISTANCE_QUANTILES; i++) {
+		double u = (i + 0.5) / NUM_DISTANCE_QUANTILES;
+		double d = p >= 1 ? 1 : 1 + std::floor(std::log(1 - u) / std::log(1 - p));
+		distanceQuantiles[i] = std::min<double>(d, SYNTHETIC_MAX_DEPENDENCY_DISTANCE - 1);
+	}
+	rewind();
+}
+
+// splitmix64
+uint64_t SyntheticTraceSource::nextRandom() {
+	uint64_t z = (rngState += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+uint32_t SyntheticTraceSource::sourceRegister() {
+	if(params.meanDependencyDistance == 0)
+		return randomRegister();
+	uint32_t distance = distanceQuantiles[nextRandom() & (NUM_DISTANCE_QUANTILES - 1)];
+	// Producers before the start of the trace or without a destination
+	// leave the operand to chance.
+	uint32_t producer = recentDst[(pos - distance) % SYNTHETIC_MAX_DEPENDENCY_DISTANCE];
+	if(distance > pos || producer == (uint32_t) -1)
+		return randomRegister();
+	return producer;
+}
+
+uint32_t SyntheticTraceSource::destinationRegister() {
+	if(reuseThreshold > 0 && (nextRandom() >> 11) < reuseThreshold) {
+		uint32_t back = 1 + randomBelow(params.reuseWindow);
+		uint32_t reg = recentDst[(pos - back) % SYNTHETIC_MAX_DEPENDENCY_DISTANCE];
+		if(back <= pos && reg != (uint32_t) -1)
+			return reg;
+	}
+	return randomRegister();
+}
+
+size_t SyntheticTraceSource::read(StaticInstruction* batch, size_t maxCount) {
+	size_t count = 0;
+	for(; count < maxCount && pos < params.length; count++, pos++) {
+		uint64_t r = nextRandom() >> 11;
+		int t = 0;
+		while(t < 3 && r >= mixThresholds[t])
+			t++;
+		char type = mixTypes[t];
+		StaticInstruction& inst = batch[count];
+		inst.type = type;
+		inst.srcOp1 = sourceRegister();
+		inst.srcOp2 = type == InstrType_IMM || type == InstrType_LOAD ? -1 : sourceRegister();
+		inst.immediate = type == InstrType_REG ? -1 : nextRandom() & 0xff;
+		inst.dstOp = type == InstrType_STORE ? -1 : destinationRegister();
+
+		if(type == InstrType_LOAD && numRecentStores > 0 && aliasThreshold > 0 &&
+				(nextRandom() >> 11) < aliasThreshold) {
+			uint32_t store = randomBelow(std::min<uint64_t>(numRecentStores, NUM_RECENT_STORES));
+			inst.srcOp1 = recentStoreBase[store];
+			inst.immediate = recentStoreImm[store];
+		}
+		if(type == InstrType_STORE) {
+			uint32_t slot = numRecentStores++ % NUM_RECENT_STORES;
+			recentStoreBase[slot] = inst.srcOp1;
+			recentStoreImm[slot] = inst.immediate;
+		}
+		recentDst[pos % SYNTHETIC_MAX_DEPENDENCY_DISTANCE] = inst.dstOp;
+	}
+	return count;
+}
+
+bool SyntheticTraceSource::rewind() {
+	rngState = params.seed;
+	pos = 0;
+	numRecentStores = 0;
+	memset(recentDst, 0xff, sizeof(recentDst));
+	return true;
+}
@@ -0,0 +1,72 @@
+#ifndef SRC_SYNTHETIC_TRACE_H_
+#define SRC_SYNTHETIC_TRACE_H_
+
+#include "trace_source.h"
+
+// Farthest producer a synthetic dependency can reach back to.
+#define SYNTHETIC_MAX_DEPENDENCY_DISTANCE 256
+
+struct SyntheticTraceParams {
+	InstrNum length;
+	uint32_t numArchRegs;
+	// Relative weights of R, I, L and S instructions.
+	double mix[4];
+	// Sources read the destination of the instruction this many back,
+	// geometrically distributed with this mean; 0 picks registers
+	// uniformly instead.
+	double meanDependencyDistance;
+	// Fraction of destinations reusing one of the last reuseWindow
+	// destinations instead of a uniformly chosen register.
+	double registerReuse;
+	uint32_t reuseWindow;
+	// Fraction of loads reading the address, i.e. base register and
+	// immediate, of one of the last few stores.
+	double aliasRate;
+	uint64_t seed;
+
+	// A uniform mix of independent instructions over 32 registers.
+	SyntheticTraceParams();
+};
+
+// Random instructions following SyntheticTraceParams. The same
+// parameters always produce the same trace.
+class SyntheticTraceSource : public TraceSource {
+	SyntheticTraceParams params;
+	// Cumulative mix and the probabilities above, as thresholds for
+	// 53-bit random numbers.
+	uint64_t mixThresholds[4];
+	uint64_t reuseThreshold;
+	uint64_t aliasThreshold;
+	// Dependency distances at evenly spaced quantiles, sampled by index.
+	uint16_t distanceQuantiles[4096];
+	// Destination of each recent instruction, -1 for stores.
+	uint32_t recentDst[SYNTHETIC_MAX_DEPENDENCY_DISTANCE];
+	// Base register and immediate of recent stores.
+	uint32_t recentStoreBase[8];
+	uint32_t recentStoreImm[8];
+	uint64_t numRecentStores;
+	uint64_t rngState;
+	InstrNum pos;
+
+	uint64_t nextRandom();
+	// Uniform in [0, n) without a division.
+	uint32_t randomBelow(uint32_t n) {
+		return ((nextRandom() >> 32) * n) >> 32;
+	}
+	uint32_t randomRegister() {
+		return randomBelow(params.numArchRegs);
+	}
+	uint32_t sourceRegister();
+	uint32_t destinationRegister();
+public:
+	SyntheticTraceSource(const SyntheticTraceParams& params);
+
+	size_t read(StaticInstruction* batch, size_t maxCount);
+	bool rewind();
+
+	InstrNum size() const {
+		return params.length;
+	}
+};
+
+#endif /* SRC_SYNTHETIC_TRACE_H_ */
@@ -0,0 +1,243 @@
+#include "timing_comparison.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+void StageDeltaStats::add(int64_t delta) {
+	if(differing == 0 || delta < minDelta)
+		minDelta = delta;
+	if(differing == 0 || delta > maxDelta)
+		maxDelta = delta;
+	differing++;
+	sumDelta += delta;
+	sumAbsDelta += delta < 0 ? -delta : delta;
+}
+
+static std::string getWaitName(int wait) {
+	return std::string(getStageName((TimingStage) wait)) + "->" +
+			getStageName((TimingStage) (wait + 1));
+}
+
+static std::string formatDelta(int64_t delta) {
+	return (delta > 0 ? "+" : "") + std::to_string(delta);
+}
+
+static void writeRow(std::ostream& out, const char* label, const TimingRow& row) {
+	out << "    " << label << ":";
+	for(int s = 0; s < Stage_COUNT; s++) {
+		if(row.cycles[s] == CYCLE_UNSET)
+			out << " -";
+		else
+			out << " " << row.cycles[s];
+	}
+	out << "\n";
+}
+
+TimingComparison::TimingComparison(uint32_t regionSize, size_t numTop) :
+	regionSize(regionSize ? regionSize : 1), numTop(numTop), numRows(0),
+	firstDivergence(INSTR_NONE), firstDivergenceStage(Stage_FETCH), unchanged(0) {
+}
+
+TimingComparison::~TimingComparison() {
+}
+
+void TimingComparison::compare(const std::vector<TimingRow>& a, const std::vector<TimingRow>& b) {
+	numRows = std::min(a.size(), b.size());
+	firstDivergence = INSTR_NONE;
+	firstDivergenceStage = Stage_FETCH;
+	std::fill_n(stages, Stage_COUNT, StageDeltaStats {});
+	std::fill_n(waits, Stage_COUNT - 1, StageDeltaStats {});
+	slower.clear();
+	faster.clear();
+	unchanged = 0;
+	changed.clear();
+	regions.assign((numRows + regionSize - 1) / regionSize, Region {});
+
+	// Latest retire so far, which ends the previous region.
+	Cycle endA = 0;
+	Cycle endB = 0;
+	for(size_t i = 0; i < numRows; i++) {
+		const TimingRow& rowA = a[i];
+		const TimingRow& rowB = b[i];
+		Region& region = regions[i / regionSize];
+		for(int s = 0; s < Stage_COUNT; s++) {
+			Cycle ca = rowA.cycles[s];
+			Cycle cb = rowB.cycles[s];
+			if(ca == cb)
+				continue;
+			if(firstDivergence == INSTR_NONE) {
+				firstDivergence = i;
+				firstDivergenceStage = (TimingStage) s;
+			}
+			if(ca == CYCLE_UNSET || cb == CYCLE_UNSET)
+				stages[s].unsetMismatches++;
+			else
+				stages[s].add((int64_t) cb - (int64_t) ca);
+		}
+		for(int w = 0; w < Stage_COUNT - 1; w++) {
+			if(rowA.cycles[w] == CYCLE_UNSET || rowA.cycles[w + 1] == CYCLE_UNSET ||
+					rowB.cycles[w] == CYCLE_UNSET || rowB.cycles[w + 1] == CYCLE_UNSET)
+				continue;
+			int64_t delta = (int64_t) (rowB.cycles[w + 1] - rowB.cycles[w]) -
+					(int64_t) (rowA.cycles[w + 1] - rowA.cycles[w]);
+			if(delta == 0)
+				continue;
+			waits[w].add(delta);
+			region.waitDeltas[w] += delta;
+		}
+
+		Cycle retireA = rowA.cycles[Stage_RETIRE];
+		Cycle retireB = rowB.cycles[Stage_RETIRE];
+		if(retireA != CYCLE_UNSET && retireA > endA) {
+			region.cyclesA += retireA - endA;
+			endA = retireA;
+		}
+		if(retireB != CYCLE_UNSET && retireB > endB) {
+			region.cyclesB += retireB - endB;
+			endB = retireB;
+		}
+		if(retireA == CYCLE_UNSET || retireB == CYCLE_UNSET ||
+				rowA.cycles[Stage_FETCH] == CYCLE_UNSET || rowB.cycles[Stage_FETCH] == CYCLE_UNSET)
+			continue;
+		int64_t delta = (int64_t) (retireB - rowB.cycles[Stage_FETCH]) -
+				(int64_t) (retireA - rowA.cycles[Stage_FETCH]);
+		if(delta == 0) {
+			unchanged++;
+			continue;
+		}
+		if(delta > 0)
+			slower.add(delta);
+		else
+			faster.add(-delta);
+		if(numTop == 0)
+			continue;
+		Changed change = { delta, i };
+		if(changed.size() == numTop) {
+			if(!(change < changed.front()))
+				continue;
+			std::pop_heap(changed.begin(), changed.end());
+			changed.pop_back();
+		}
+		changed.push_back(change);
+		std::push_heap(changed.begin(), changed.end());
+	}
+}
+
+void TimingComparison::writeWaits(std::ostream& out, const TimingRow& a, const TimingRow& b) const {
+	const char* separator = " (";
+	for(int w = 0; w < Stage_COUNT - 1; w++) {
+		if(a.cycles[w] == CYCLE_UNSET || a.cycles[w + 1] == CYCLE_UNSET ||
+				b.cycles[w] == CYCLE_UNSET || b.cycles[w + 1] == CYCLE_UNSET)
+			continue;
+		int64_t delta = (int64_t) (b.cycles[w + 1] - b.cycles[w]) -
+				(int64_t) (a.cycles[w + 1] - a.cycles[w]);
+		if(delta == 0)
+			continue;
+		out << separator << getWaitName(w) << " " << formatDelta(delta);
+		separator = ", ";
+	}
+	if(separator[0] == ',')
+		out << ")";
+}
+
+void TimingComparison::write(std::ostream& out, const std::vector<TimingRow>& a,
+		const std::vector<TimingRow>& b) const {
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	out << std::fixed << std::setprecision(2);
+	out << "per-stage deltas (b - a) over " << numRows << " instructions:\n";
+	out << "  stage     differing    unset      min      max     mean  mean|d|\n";
+	for(int s = 0; s < Stage_COUNT; s++) {
+		const StageDeltaStats& st = stages[s];
+		double n = st.differing ? st.differing : 1;
+		out << "  " << std::left << std::setw(9) << getStageName((TimingStage) s) << std::right <<
+				" " << std::setw(9) << st.differing << " " << std::setw(8) << st.unsetMismatches <<
+				" " << std::setw(8) << st.minDelta << " " << std::setw(8) << st.maxDelta << " " <<
+				std::setw(8) << st.sumDelta / n << " " << std::setw(8) << st.sumAbsDelta / n << "\n";
+	}
+
+	out << "\nwaits between stages (b - a):\n";
+	out << "  wait                differing      min      max     mean      total\n";
+	for(int w = 0; w < Stage_COUNT - 1; w++) {
+		const StageDeltaStats& st = waits[w];
+		double n = st.differing ? st.differing : 1;
+		out << "  " << std::left << std::setw(19) << getWaitName(w) << std::right <<
+				std::setw(10) << st.differing << " " << std::setw(8) << st.minDelta << " " <<
+				std::setw(8) << st.maxDelta << " " << std::setw(8) << st.sumDelta / n << " " <<
+				std::setw(10) << st.sumDelta << "\n";
+	}
+
+	out << "\nfetch to retire latency (b - a): " << unchanged << " unchanged, " <<
+			slower.getCount() << " slower, " << faster.getCount() << " faster\n";
+	if(slower.getCount()) {
+		out << "  slower by, mean " << slower.getMean() << ":\n";
+		slower.write(out, "  ");
+	}
+	if(faster.getCount()) {
+		out << "  faster by, mean " << faster.getMean() << ":\n";
+		faster.write(out, "  ");
+	}
+
+	if(!changed.empty()) {
+		out << "\nlargest latency changes:\n";
+		std::vector<Changed> sorted = changed;
+		std::sort(sorted.begin(), sorted.end());
+		for(const Changed& change : sorted) {
+			out << "  #" << change.instrNumber << ": " << formatDelta(change.delta) << " cycles";
+			writeWaits(out, a[change.instrNumber], b[change.instrNumber]);
+			out << "\n";
+			writeRow(out, "a", a[change.instrNumber]);
+			writeRow(out, "b", b[change.instrNumber]);
+		}
+	}
+
+	std::vector<size_t> ranked;
+	int64_t total = 0;
+	for(size_t r = 0; r < regions.size(); r++) {
+		int64_t delta = (int64_t) regions[r].cyclesB - (int64_t) regions[r].cyclesA;
+		total += delta;
+		if(delta != 0)
+			ranked.push_back(r);
+	}
+	if(ranked.empty()) {
+		out.flags(flags);
+		out.precision(precision);
+		return;
+	}
+	auto size = [this](size_t r) {
+		int64_t delta = (int64_t) regions[r].cyclesB - (int64_t) regions[r].cyclesA;
+		return delta < 0 ? -delta : delta;
+	};
+	std::stable_sort(ranked.begin(), ranked.end(), [&size](size_t x, size_t y) {
+		return size(x) > size(y);
+	});
+	if(numTop != 0 && ranked.size() > numTop)
+		ranked.resize(numTop);
+	out << "\nregions of " << regionSize << " instructions that diverge most, " <<
+			formatDelta(total) << " cycles in all:\n";
+	out << "  " << std::left << std::setw(20) << "instructions" << std::right << std::setw(10) <<
+			"a cycles" << std::setw(10) << "b cycles" << std::setw(10) << "delta" <<
+			"  wait that changed most, summed\n";
+	for(size_t r : ranked) {
+		const Region& region = regions[r];
+		size_t first = r * regionSize;
+		size_t last = std::min(first + regionSize, numRows) - 1;
+		int largest = 0;
+		for(int w = 1; w < Stage_COUNT - 1; w++) {
+			int64_t delta = region.waitDeltas[w];
+			int64_t most = region.waitDeltas[largest];
+			if((delta < 0 ? -delta : delta) > (most < 0 ? -most : most))
+				largest = w;
+		}
+		out << "  " << std::left << std::setw(20) <<
+				(std::to_string(first) + "-" + std::to_string(last)) << std::right <<
+				std::setw(10) << region.cyclesA << std::setw(10) << region.cyclesB <<
+				std::setw(10) << formatDelta((int64_t) region.cyclesB - (int64_t) region.cyclesA);
+		if(region.waitDeltas[largest] != 0)
+			out << "  " << getWaitName(largest) << " " << formatDelta(region.waitDeltas[largest]);
+		out << "\n";
+	}
+	out.flags(flags);
+	out.precision(precision);
+}
@@ -0,0 +1,110 @@
+#ifndef SRC_TIMING_COMPARISON_H_
+#define SRC_TIMING_COMPARISON_H_
+
+#include <ostream>
+#include <vector>
+
+#include "histogram.h"
+#include "timing_file.h"
+#include "utils.h"
+
+// Instructions per region unless told otherwise.
+#define COMPARISON_DEFAULT_REGION 256
+// Instructions and regions listed unless told otherwise.
+#define COMPARISON_DEFAULT_TOP 10
+
+// Deltas (b - a) of one stage, or of the wait between two stages.
+struct StageDeltaStats {
+	uint64_t differing;
+	// One side set and the other unset.
+	uint64_t unsetMismatches;
+	int64_t minDelta;
+	int64_t maxDelta;
+	int64_t sumDelta;
+	uint64_t sumAbsDelta;
+
+	void add(int64_t delta);
+};
+
+/*
+ * Where two results for the same trace, a and b, differ, e.g. before and
+ * after changing one parameter:
+ *
+ *  - per stage, how much later b entered it;
+ *  - per wait between consecutive stages, how much longer b waited, which
+ *    is where the time went;
+ *  - the distribution of fetch to retire latency deltas, and the
+ *    instructions whose latency changed most;
+ *  - the regions of regionSize instructions whose retirement took most
+ *    more or fewer cycles. Their deltas sum to the change in total cycles,
+ *    so they show where in the trace the difference comes from.
+ *
+ * Deltas are b - a throughout: positive means b is slower.
+ */
+class TimingComparison {
+	struct Changed {
+		int64_t delta;
+		InstrNum instrNumber;
+
+		// Orders the heap so that its front is the smallest change kept.
+		bool operator<(const Changed& other) const {
+			uint64_t size = delta < 0 ? -delta : delta;
+			uint64_t otherSize = other.delta < 0 ? -other.delta : other.delta;
+			return size > otherSize || (size == otherSize && instrNumber < other.instrNumber);
+		}
+	};
+	struct Region {
+		// Cycles from the end of the previous region to the last retire in
+		// this one.
+		Cycle cyclesA;
+		Cycle cyclesB;
+		// Summed over the region, per wait between stages.
+		int64_t waitDeltas[Stage_COUNT - 1];
+	};
+
+	uint32_t regionSize;
+	size_t numTop;
+	size_t numRows;
+	InstrNum firstDivergence;
+	TimingStage firstDivergenceStage;
+	StageDeltaStats stages[Stage_COUNT];
+	// Wait from stage s to stage s + 1, for instructions with both set in
+	// both results.
+	StageDeltaStats waits[Stage_COUNT - 1];
+	// Fetch to retire latency deltas, by sign.
+	Histogram slower;
+	Histogram faster;
+	uint64_t unchanged;
+	// Heap of the numTop largest latency changes.
+	std::vector<Changed> changed;
+	std::vector<Region> regions;
+
+	void writeWaits(std::ostream& out, const TimingRow& a, const TimingRow& b) const;
+public:
+	TimingComparison(uint32_t regionSize = COMPARISON_DEFAULT_REGION,
+			size_t numTop = COMPARISON_DEFAULT_TOP);
+	virtual ~TimingComparison();
+
+	void compare(const std::vector<TimingRow>& a, const std::vector<TimingRow>& b);
+
+	// Whether the rows both results have are the same.
+	bool isIdentical() const {
+		return firstDivergence == INSTR_NONE;
+	}
+
+	// First instruction with a differing stage, INSTR_NONE if none.
+	InstrNum getFirstDivergence(TimingStage& stage) const {
+		stage = firstDivergenceStage;
+		return firstDivergence;
+	}
+
+	const StageDeltaStats& getStageDeltas(TimingStage stage) const {
+		return stages[stage];
+	}
+
+	// Everything above; a and b must be the rows compared.
+	void write(std::ostream& out, const std::vector<TimingRow>& a,
+			const std::vector<TimingRow>& b) const;
+};
+
+#endif /* SRC_TIMING_COMPARISON_H_ */
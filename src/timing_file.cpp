@@ -0,0 +1,278 @@
+#include "timing_file.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#define TIMING_FILE_MAGIC "R10KTIME"
+#define TIMING_FILE_MAGIC_LEN 8
+#define TIMING_FILE_VERSION 1
+// Unset marker of text files written with 32-bit cycle counters.
+#define LEGACY_CYCLE_UNSET 4294967295ULL
+
+static void putFixed(std::string& buf, uint64_t value, int bytes) {
+	for(int i = 0; i < bytes; i++)
+		buf.push_back((char) ((value >> (8 * i)) & 0xff));
+}
+
+static void putVarint(std::string& buf, uint64_t value) {
+	while(value >= 0x80) {
+		buf.push_back((char) ((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	buf.push_back((char) value);
+}
+
+static bool getFixed(const std::string& buf, size_t& pos, uint64_t& value, int bytes) {
+	if(pos + bytes > buf.size())
+		return false;
+	value = 0;
+	for(int i = 0; i < bytes; i++)
+		value |= (uint64_t) (uint8_t) buf[pos + i] << (8 * i);
+	pos += bytes;
+	return true;
+}
+
+static bool getVarint(const std::string& buf, size_t& pos, size_t end, uint64_t& value) {
+	value = 0;
+	for(int shift = 0; pos < end && shift < 64; shift += 7) {
+		uint8_t byte = buf[pos++];
+		value |= (uint64_t) (byte & 0x7f) << shift;
+		if((byte & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
+
+static uint64_t encodeDelta(Cycle value, Cycle base) {
+	if(value == CYCLE_UNSET)
+		return 0;
+	int64_t delta = (int64_t) value - (int64_t) base;
+	return (((uint64_t) delta << 1) ^ (uint64_t) (delta >> 63)) + 1;
+}
+
+static Cycle decodeDelta(uint64_t code, Cycle base) {
+	if(code == 0)
+		return CYCLE_UNSET;
+	code--;
+	int64_t delta = (int64_t) (code >> 1) ^ -(int64_t) (code & 1);
+	return base + delta;
+}
+
+// Text names of the dispatch stall codes.
+static const char* stallCodeNames[STALL_CODE_COUNT] = {
+	"-", "rob_full", "rs_busy", "free_list_empty"
+};
+
+const char* getStallCodeName(uint8_t code) {
+	return stallCodeNames[code];
+}
+
+static void writeInstr(std::ostream& out, InstrNum instrNumber) {
+	if(instrNumber == INSTR_NONE)
+		out << -1;
+	else
+		out << instrNumber;
+}
+
+static bool readInstr(std::istream& in, InstrNum& instrNumber) {
+	int64_t value;
+	if(!(in >> value) || value < -1)
+		return false;
+	instrNumber = value == -1 ? INSTR_NONE : value;
+	return true;
+}
+
+// Delta base for stage s of row: the latest set stage before s, or, for
+// the fetch column, the previous instruction's fetch.
+static Cycle deltaBase(const TimingRow& row, int stage, Cycle prevFetch) {
+	for(int s = stage - 1; s >= 0; s--)
+		if(row.cycles[s] != CYCLE_UNSET)
+			return row.cycles[s];
+	return prevFetch;
+}
+
+TimingFile::TimingFile() : hasHeader(false) {
+	memset(&header, 0, sizeof(header));
+}
+
+TimingFile::~TimingFile() {
+}
+
+bool TimingFile::load(std::string path) {
+	std::ifstream in(path, std::ios::binary);
+	if(!in.is_open()) {
+		std::cerr << "Cannot open timing file " << path << "\n";
+		return false;
+	}
+	char magic[TIMING_FILE_MAGIC_LEN] = {0};
+	in.read(magic, TIMING_FILE_MAGIC_LEN);
+	in.close();
+	if(memcmp(magic, TIMING_FILE_MAGIC, TIMING_FILE_MAGIC_LEN) == 0)
+		return loadBinary(path);
+	return loadText(path);
+}
+
+bool TimingFile::loadText(std::string path) {
+	std::ifstream in(path);
+	if(!in.is_open()) {
+		std::cerr << "Cannot open timing file " << path << "\n";
+		return false;
+	}
+	hasHeader = false;
+	rows.clear();
+	stallRows.clear();
+	TimingRow row;
+	std::string line;
+	while(std::getline(in, line)) {
+		std::istringstream fields(line);
+		if(!(fields >> row.cycles[0]))
+			continue;
+		for(int s = 1; s < Stage_COUNT; s++) {
+			if(!(fields >> row.cycles[s])) {
+				std::cerr << path << ": truncated line " << rows.size() + 1 << "\n";
+				return false;
+			}
+		}
+		for(int s = 0; s < Stage_COUNT; s++)
+			if(row.cycles[s] == LEGACY_CYCLE_UNSET)
+				row.cycles[s] = CYCLE_UNSET;
+		// Stall attribution, all or nothing.
+		std::string stall;
+		if((fields >> stall) || !stallRows.empty()) {
+			StallRow stallRow;
+			int code = 0;
+			while(code < STALL_CODE_COUNT && stall != stallCodeNames[code])
+				code++;
+			int operand;
+			if(stallRows.size() != rows.size() || code == STALL_CODE_COUNT ||
+					!(fields >> operand) || operand < 0 || operand > 2 ||
+					!readInstr(fields, stallRow.issueProducer) ||
+					!readInstr(fields, stallRow.retireBlocker)) {
+				std::cerr << path << ": bad stall attribution on line " << rows.size() + 1 << "\n";
+				return false;
+			}
+			stallRow.dispatchStall = code;
+			stallRow.issueOperand = operand;
+			stallRows.push_back(stallRow);
+		}
+		rows.push_back(row);
+	}
+	return true;
+}
+
+bool TimingFile::loadBinary(std::string path) {
+	std::ifstream in(path, std::ios::binary);
+	if(!in.is_open()) {
+		std::cerr << "Cannot open timing file " << path << "\n";
+		return false;
+	}
+	std::string buf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	size_t pos = TIMING_FILE_MAGIC_LEN;
+	uint64_t version;
+	if(buf.compare(0, TIMING_FILE_MAGIC_LEN, TIMING_FILE_MAGIC) != 0 ||
+			!getFixed(buf, pos, version, 4) || version != TIMING_FILE_VERSION) {
+		std::cerr << path << ": not a version " << TIMING_FILE_VERSION << " timing file\n";
+		return false;
+	}
+	if(!parseBinary(buf, pos)) {
+		std::cerr << path << ": truncated timing file\n";
+		return false;
+	}
+	return true;
+}
+
+bool TimingFile::parseBinary(const std::string& buf, size_t pos) {
+	uint64_t numRows, value;
+	uint32_t* config[] = { &header.numArchRegs, &header.numPhysicalRegs,
+			&header.robEntries, &header.width, &header.numLSQEntries };
+	for(int i = 0; i < 5; i++) {
+		if(!getFixed(buf, pos, value, 4))
+			return false;
+		*config[i] = value;
+	}
+	if(!getFixed(buf, pos, header.traceHash, 8) || !getFixed(buf, pos, numRows, 8))
+		return false;
+	hasHeader = true;
+	stallRows.clear();
+	rows.assign(numRows, TimingRow());
+
+	for(int s = 0; s < Stage_COUNT; s++) {
+		uint64_t columnBytes;
+		if(!getFixed(buf, pos, columnBytes, 8) || pos + columnBytes > buf.size())
+			return false;
+		size_t end = pos + columnBytes;
+		Cycle prevFetch = 0;
+		for(uint64_t i = 0; i < numRows; i++) {
+			if(!getVarint(buf, pos, end, value))
+				return false;
+			rows[i].cycles[s] = decodeDelta(value, deltaBase(rows[i], s, prevFetch));
+			if(s == Stage_FETCH && rows[i].cycles[s] != CYCLE_UNSET)
+				prevFetch = rows[i].cycles[s];
+		}
+		pos = end;
+	}
+	return true;
+}
+
+bool TimingFile::saveText(std::string path) const {
+	std::ofstream out(path);
+	if(!out.is_open()) {
+		std::cerr << "Cannot open output file to write!\n";
+		return false;
+	}
+	for(size_t i = 0; i < rows.size(); i++) {
+		const TimingRow& row = rows[i];
+		for(int s = 0; s < Stage_COUNT; s++) {
+			if(row.cycles[s] == CYCLE_UNSET)
+				out << -1;
+			else
+				out << row.cycles[s];
+			if(s + 1 < Stage_COUNT)
+				out << " ";
+		}
+		if(!stallRows.empty()) {
+			const StallRow& stall = stallRows[i];
+			out << " " << stallCodeNames[stall.dispatchStall] << " " << (int) stall.issueOperand << " ";
+			writeInstr(out, stall.issueProducer);
+			out << " ";
+			writeInstr(out, stall.retireBlocker);
+		}
+		out << "\n";
+	}
+	return out.good();
+}
+
+bool TimingFile::saveBinary(std::string path) const {
+	std::ofstream out(path, std::ios::binary);
+	if(!out.is_open()) {
+		std::cerr << "Cannot open output file to write!\n";
+		return false;
+	}
+	std::string buf(TIMING_FILE_MAGIC);
+	putFixed(buf, TIMING_FILE_VERSION, 4);
+	putFixed(buf, header.numArchRegs, 4);
+	putFixed(buf, header.numPhysicalRegs, 4);
+	putFixed(buf, header.robEntries, 4);
+	putFixed(buf, header.width, 4);
+	putFixed(buf, header.numLSQEntries, 4);
+	putFixed(buf, header.traceHash, 8);
+	putFixed(buf, rows.size(), 8);
+	out.write(buf.data(), buf.size());
+
+	std::string column;
+	for(int s = 0; s < Stage_COUNT; s++) {
+		column.clear();
+		Cycle prevFetch = 0;
+		for(const TimingRow& row : rows) {
+			putVarint(column, encodeDelta(row.cycles[s], deltaBase(row, s, prevFetch)));
+			if(s == Stage_FETCH && row.cycles[s] != CYCLE_UNSET)
+				prevFetch = row.cycles[s];
+		}
+		buf.clear();
+		putFixed(buf, column.size(), 8);
+		out.write(buf.data(), buf.size());
+		out.write(column.data(), column.size());
+	}
+	return out.good();
+}
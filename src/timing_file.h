@@ -0,0 +1,115 @@
+#ifndef SRC_TIMING_FILE_H_
+#define SRC_TIMING_FILE_H_
+
+#include <string>
+#include <vector>
+
+#include "utils.h"
+
+// One line of the output file: the cycle each stage was entered,
+// CYCLE_UNSET if the instruction never got there.
+struct TimingRow {
+	Cycle cycles[Stage_COUNT];
+};
+
+// Dispatch stall codes of a StallRow: the StallReason plus one.
+#define STALL_CODE_NONE 0
+#define STALL_CODE_COUNT 4
+
+// Why an instruction waited, see BasicCPU::setStallAttribution().
+struct StallRow {
+	// Stall behind most of its decode to dispatch cycles.
+	uint8_t dispatchStall;
+	// Source operand, 1 or 2, it was still waiting for when it was
+	// dispatched and that was ready last, 0 if none; and the instruction
+	// that produced it.
+	uint8_t issueOperand;
+	InstrNum issueProducer;
+	// The older instruction that completed last, if after this one did, so
+	// that retirement waited for it; INSTR_NONE otherwise.
+	InstrNum retireBlocker;
+};
+
+// "rob_full", "rs_busy", "free_list_empty", or "-" for STALL_CODE_NONE.
+const char* getStallCodeName(uint8_t code);
+
+struct TimingFileHeader {
+	uint32_t numArchRegs;
+	uint32_t numPhysicalRegs;
+	uint32_t robEntries;
+	uint32_t width;
+	uint32_t numLSQEntries;
+	uint64_t traceHash;
+};
+
+/*
+ * Simulation results in either the text format written by
+ * CPU::generateOutputFile() or the columnar binary format:
+ *
+ *   "R10KTIME" | version | config | trace hash | #instructions
+ *   then, for each stage, a byte count followed by one varint per
+ *   instruction.
+ *
+ * Fetch cycles are delta encoded against the previous instruction's fetch,
+ * every other stage against the latest earlier stage of the same
+ * instruction. A varint of 0 means "unset", otherwise it holds the
+ * zigzagged delta plus one. Text files carry no header, so hasHeader is
+ * only set for binary files. Unset stages are written as -1 in text; the
+ * 4294967295 written by the old 32-bit counters is read back as unset.
+ *
+ * Text files may carry stall attribution (StallRow) after the timestamps:
+ * the dispatch stall (rob_full, rs_busy, free_list_empty or -), the issue
+ * operand, its producer and the retire blocker, -1 for none. Binary files
+ * only hold timestamps.
+ */
+class TimingFile {
+	bool hasHeader;
+	TimingFileHeader header;
+	std::vector<TimingRow> rows;
+	// Empty unless the file has stall attribution, else one per row.
+	std::vector<StallRow> stallRows;
+
+	bool parseBinary(const std::string& buf, size_t pos);
+public:
+	TimingFile();
+	virtual ~TimingFile();
+
+	// Detects the format from the file magic.
+	bool load(std::string path);
+	bool loadText(std::string path);
+	bool loadBinary(std::string path);
+
+	bool saveText(std::string path) const;
+	bool saveBinary(std::string path) const;
+
+	void setHeader(const TimingFileHeader& header) {
+		this->header = header;
+		hasHeader = true;
+	}
+
+	bool isHeaderValid() const {
+		return hasHeader;
+	}
+
+	const TimingFileHeader& getHeader() const {
+		return header;
+	}
+
+	std::vector<TimingRow>& getRows() {
+		return rows;
+	}
+
+	const std::vector<TimingRow>& getRows() const {
+		return rows;
+	}
+
+	std::vector<StallRow>& getStallRows() {
+		return stallRows;
+	}
+
+	const std::vector<StallRow>& getStallRows() const {
+		return stallRows;
+	}
+};
+
+#endif /* SRC_TIMING_FILE_H_ */
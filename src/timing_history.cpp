@@ -0,0 +1,45 @@
+#include "timing_history.h"
+
+TimingHistory::TimingHistory() {
+}
+
+TimingHistory::~TimingHistory() {
+}
+
+void TimingHistory::addInstruction(Cycle fetchCycle) {
+	Entry entry;
+	entry.fetchCycle = fetchCycle;
+	for(int s = 0; s < Stage_COUNT - 1; s++)
+		entry.stageOffsets[s] = STAGE_OFFSET_UNSET;
+	entries.push_back(entry);
+}
+
+void TimingHistory::setStageCycle(InstrNum instrNumber, TimingStage stage, Cycle cycle) {
+	Entry& entry = entries[instrNumber];
+	if(stage == Stage_FETCH) {
+		entry.fetchCycle = cycle;
+		return;
+	}
+	if(cycle < entry.fetchCycle || cycle - entry.fetchCycle >= STAGE_OFFSET_UNSET) {
+		std::cerr << "inst " << instrNumber << " " << __func__ << " cycle " << cycle <<
+				" out of range of fetch cycle " << entry.fetchCycle << "\n";
+		assert(false);
+	}
+	entry.stageOffsets[stage - 1] = cycle - entry.fetchCycle;
+}
+
+Cycle TimingHistory::getStageCycle(InstrNum instrNumber, TimingStage stage) const {
+	if(instrNumber >= entries.size())
+		return CYCLE_UNSET;
+	const Entry& entry = entries[instrNumber];
+	if(stage == Stage_FETCH)
+		return entry.fetchCycle;
+	if(entry.stageOffsets[stage - 1] == STAGE_OFFSET_UNSET)
+		return CYCLE_UNSET;
+	return entry.fetchCycle + entry.stageOffsets[stage - 1];
+}
+
+void TimingHistory::getRow(InstrNum instrNumber, TimingRow& row) const {
+	for(int s = 0; s < Stage_COUNT; s++)
+		row.cycles[s] = getStageCycle(instrNumber, (TimingStage) s);
+}
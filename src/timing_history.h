@@ -0,0 +1,48 @@
+#ifndef SRC_TIMING_HISTORY_H_
+#define SRC_TIMING_HISTORY_H_
+
+#include <vector>
+
+#include "timing_file.h"
+#include "utils.h"
+
+// Stage offset of a stage the instruction has not reached yet.
+#define STAGE_OFFSET_UNSET UINT32_MAX
+
+/*
+ * Stage timestamps of every fetched instruction, indexed by instruction
+ * number. Kept apart from the in-flight Instruction records so that the
+ * pipeline only touches one 32-byte entry when a stage is entered.
+ */
+class TimingHistory {
+	struct Entry {
+		Cycle fetchCycle;
+		// Later stages relative to fetchCycle.
+		uint32_t stageOffsets[Stage_COUNT - 1];
+	};
+	std::vector<Entry> entries;
+public:
+	TimingHistory();
+	virtual ~TimingHistory();
+
+	// Appends the entry of the next instruction in program order.
+	void addInstruction(Cycle fetchCycle);
+
+	void setStageCycle(InstrNum instrNumber, TimingStage stage, Cycle cycle);
+	Cycle getStageCycle(InstrNum instrNumber, TimingStage stage) const;
+	void getRow(InstrNum instrNumber, TimingRow& row) const;
+
+	void reserve(InstrNum numInstructions) {
+		entries.reserve(numInstructions);
+	}
+
+	InstrNum size() const {
+		return entries.size();
+	}
+
+	void clear() {
+		entries.clear();
+	}
+};
+
+#endif /* SRC_TIMING_HISTORY_H_ */
@@ -0,0 +1,81 @@
+#include "trace_buffer.h"
+#include <algorithm>
+
+// Instructions requested from the source per read().
+#define TRACE_BATCH_SIZE 256
+// Most instructions reserved at once for a source of known length.
+#define TRACE_BUFFER_RESERVE_LIMIT (1 << 20)
+
+TraceBuffer::TraceBuffer() :
+	source(nullptr), sourceStart(0), head(0), count(0), first(0), hash(FNV1A_OFFSET_BASIS) {
+}
+
+TraceBuffer::~TraceBuffer() {
+}
+
+bool TraceBuffer::setSource(TraceSource* source, InstrNum start) {
+	this->source = source;
+	sourceStart = start;
+	return rewind();
+}
+
+bool TraceBuffer::rewind() {
+	head = 0;
+	count = 0;
+	first = 0;
+	hash = FNV1A_OFFSET_BASIS;
+	if(source == nullptr)
+		return false;
+	return sourceStart == 0 ? source->rewind() : source->seek(sourceStart);
+}
+
+InstrNum TraceBuffer::getSize() const {
+	if(source == nullptr)
+		return 0;
+	InstrNum size = source->size();
+	if(size == TRACE_SIZE_UNKNOWN)
+		return getNumRead();
+	return size > sourceStart ? size - sourceStart : 0;
+}
+
+void TraceBuffer::grow() {
+	size_t capacity = std::max<size_t>(2 * ring.size(), TRACE_BATCH_SIZE);
+	// Jump straight to the remaining length of the trace when it is known.
+	InstrNum size = getSize();
+	if(source->size() != TRACE_SIZE_UNKNOWN && size > first) {
+		InstrNum wanted = std::min<InstrNum>(size - first, TRACE_BUFFER_RESERVE_LIMIT);
+		while(capacity < wanted)
+			capacity *= 2;
+	}
+	std::vector<StaticInstruction> grown(capacity);
+	for(size_t i = 0; i < count; i++)
+		grown[i] = ring[(head + i) & (ring.size() - 1)];
+	ring.swap(grown);
+	head = 0;
+}
+
+bool TraceBuffer::fill(InstrNum instrNumber) {
+	if(source == nullptr)
+		return false;
+	while(instrNumber >= first + count) {
+		if(count == ring.size())
+			grow();
+		// Read into the contiguous free space after the tail.
+		size_t tail = (head + count) & (ring.size() - 1);
+		size_t space = std::min(ring.size() - count, ring.size() - tail);
+		size_t numRead = source->read(&ring[tail], std::min<size_t>(space, TRACE_BATCH_SIZE));
+		if(numRead == 0)
+			return false;
+		for(size_t i = 0; i < numRead; i++) {
+			const StaticInstruction& inst = ring[tail + i];
+			uint32_t srcOp1, srcOp2, dstOp;
+			inst.encode(srcOp1, srcOp2, dstOp);
+			hash = fnv1aUpdate(hash, inst.type);
+			hash = fnv1aUpdate(hash, srcOp1);
+			hash = fnv1aUpdate(hash, srcOp2);
+			hash = fnv1aUpdate(hash, dstOp);
+		}
+		count += numRead;
+	}
+	return true;
+}
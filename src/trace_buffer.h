@@ -0,0 +1,74 @@
+#ifndef SRC_TRACE_BUFFER_H_
+#define SRC_TRACE_BUFFER_H_
+
+#include <vector>
+
+#include "trace_source.h"
+#include "utils.h"
+
+/*
+ * Instructions read from a TraceSource that have not been dispatched yet,
+ * i.e. the ones in the front end plus one batch of lookahead. The front
+ * end runs ahead of dispatch, so the buffer grows while dispatch stalls;
+ * for sources of known length it is sized once, up to a limit.
+ */
+class TraceBuffer {
+	TraceSource* source;
+	// Trace position of instruction 0.
+	InstrNum sourceStart;
+	// Ring buffer; its size is a power of two.
+	std::vector<StaticInstruction> ring;
+	size_t head;
+	size_t count;
+	// Instruction number of ring[head].
+	InstrNum first;
+	// Fingerprint of every instruction read so far, as InstructionTrace
+	// computes it.
+	uint64_t hash;
+
+	bool fill(InstrNum instrNumber);
+	void grow();
+public:
+	TraceBuffer();
+	virtual ~TraceBuffer();
+
+	// Starts over from instruction start of source, which must outlive
+	// the buffer. Instructions are numbered from there on.
+	bool setSource(TraceSource* source, InstrNum start = 0);
+	bool rewind();
+
+	TraceSource* getSource() const {
+		return source;
+	}
+
+	// Reads from the source as needed; false past the end of the trace.
+	bool has(InstrNum instrNumber) {
+		return instrNumber < first + count || fill(instrNumber);
+	}
+
+	// Only valid for instructions has() returned true for that are not
+	// popped yet.
+	const StaticInstruction& operator[](InstrNum instrNumber) const {
+		return ring[(head + (instrNumber - first)) & (ring.size() - 1)];
+	}
+
+	// Drops the oldest instruction.
+	void pop() {
+		head = (head + 1) & (ring.size() - 1);
+		count--;
+		first++;
+	}
+
+	InstrNum getNumRead() const {
+		return first + count;
+	}
+
+	// The source's length if it knows it, otherwise how much was read.
+	InstrNum getSize() const;
+
+	uint64_t getHash() const {
+		return hash;
+	}
+};
+
+#endif /* SRC_TRACE_BUFFER_H_ */
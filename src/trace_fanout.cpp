@@ -0,0 +1,83 @@
+#include "trace_fanout.h"
+
+#include <algorithm>
+
+// Instructions read from the source at a time.
+#define FANOUT_BATCH_SIZE 4096
+
+TraceFanout::TraceFanout(TraceSource* source) :
+	source(source), windowHead(0), windowStart(0), ended(false) {
+}
+
+TraceFanout::~TraceFanout() {
+	for(Reader* reader : readers)
+		delete reader;
+}
+
+TraceSource* TraceFanout::addReader() {
+	std::lock_guard<std::mutex> lock(mutex);
+	if(windowStart != 0) {
+		std::cerr << "Cannot add a reader once the start of the trace is gone\n";
+		return nullptr;
+	}
+	readers.push_back(new Reader(this, readers.size()));
+	positions.push_back(0);
+	return readers.back();
+}
+
+bool TraceFanout::rewind() {
+	std::lock_guard<std::mutex> lock(mutex);
+	window.clear();
+	windowHead = 0;
+	windowStart = 0;
+	ended = false;
+	std::fill(positions.begin(), positions.end(), 0);
+	return source->rewind();
+}
+
+bool TraceFanout::isAtStart(size_t index) {
+	std::lock_guard<std::mutex> lock(mutex);
+	return positions[index] == 0;
+}
+
+void TraceFanout::stopReader(size_t index) {
+	std::lock_guard<std::mutex> lock(mutex);
+	positions[index] = READER_STOPPED;
+}
+
+void TraceFanout::fill(InstrNum instrNumber) {
+	InstrNum slowest = instrNumber;
+	for(InstrNum position : positions)
+		slowest = std::min(slowest, position);
+	// Readers only read past their position, so nothing before the slowest
+	// one is needed again.
+	slowest = std::min(slowest, windowStart + (window.size() - windowHead));
+	size_t numDropped = slowest - windowStart;
+	windowHead += numDropped;
+	windowStart = slowest;
+	// Move what is left to the front once the dropped part dominates.
+	if(windowHead > window.size() / 2) {
+		window.erase(window.begin(), window.begin() + windowHead);
+		windowHead = 0;
+	}
+	while(!ended && instrNumber >= windowStart + (window.size() - windowHead)) {
+		size_t size = window.size();
+		window.resize(size + FANOUT_BATCH_SIZE);
+		size_t numRead = source->read(&window[size], FANOUT_BATCH_SIZE);
+		window.resize(size + numRead);
+		if(numRead == 0)
+			ended = true;
+	}
+}
+
+size_t TraceFanout::read(size_t index, StaticInstruction* batch, size_t maxCount) {
+	std::lock_guard<std::mutex> lock(mutex);
+	InstrNum pos = positions[index];
+	if(pos + maxCount > windowStart + (window.size() - windowHead))
+		fill(pos + maxCount - 1);
+	InstrNum available = windowStart + (window.size() - windowHead) - pos;
+	size_t count = std::min<InstrNum>(maxCount, available);
+	std::copy_n(window.begin() + windowHead + (pos - windowStart), count, batch);
+	positions[index] = pos + count;
+	return count;
+}
@@ -0,0 +1,77 @@
+#ifndef SRC_TRACE_FANOUT_H_
+#define SRC_TRACE_FANOUT_H_
+
+#include <mutex>
+#include <vector>
+
+#include "trace_source.h"
+#include "utils.h"
+
+#define READER_STOPPED UINT64_MAX
+
+/*
+ * Lets several readers go through one TraceSource while it is only read
+ * and parsed once. Each reader is a TraceSource of its own; instructions
+ * are kept from the slowest reader's position on, so readers should stay
+ * close together. Readers may be used from different threads.
+ */
+class TraceFanout {
+	class Reader : public TraceSource {
+		TraceFanout* fanout;
+		size_t index;
+	public:
+		Reader(TraceFanout* fanout, size_t index) :
+			fanout(fanout), index(index) {
+		}
+
+		size_t read(StaticInstruction* batch, size_t maxCount) {
+			return fanout->read(index, batch, maxCount);
+		}
+
+		// Only possible from the start; TraceFanout::rewind() moves every
+		// reader back there.
+		bool rewind() {
+			return fanout->isAtStart(index);
+		}
+
+		InstrNum size() const {
+			return fanout->source->size();
+		}
+
+		bool getConfig(CPUConfig& config) const {
+			return fanout->source->getConfig(config);
+		}
+	};
+
+	TraceSource* source;
+	std::mutex mutex;
+	// Instruction windowStart + i is window[windowHead + i].
+	std::vector<StaticInstruction> window;
+	size_t windowHead;
+	InstrNum windowStart;
+	bool ended;
+	// Next instruction of every reader, READER_STOPPED for stopped ones.
+	std::vector<InstrNum> positions;
+	std::vector<Reader*> readers;
+
+	size_t read(size_t index, StaticInstruction* batch, size_t maxCount);
+	bool isAtStart(size_t index);
+	// Drops what every reader is past and reads until instrNumber is in.
+	void fill(InstrNum instrNumber);
+public:
+	// source must outlive the fanout.
+	TraceFanout(TraceSource* source);
+	virtual ~TraceFanout();
+	TraceFanout(const TraceFanout&) = delete;
+	TraceFanout& operator=(const TraceFanout&) = delete;
+
+	// Reads from the start of the trace; owned by the fanout.
+	TraceSource* addReader();
+	// Moves every reader back to the start of the trace.
+	bool rewind();
+	// Reader index will not read again until rewind(), so the fanout need
+	// not hold on to what it has yet to read.
+	void stopReader(size_t index);
+};
+
+#endif /* SRC_TRACE_FANOUT_H_ */
@@ -0,0 +1,239 @@
+#include "trace_profile.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#define NUM_DISTANCE_QUANTILES 4096
+#define RECENT_DST_MASK (2 * PROFILE_MAX_DEPENDENCY_DISTANCE - 1)
+#define PROFILE_BATCH_SIZE 4096
+
+static const char profileTypes[ProfileType_COUNT] = {
+	InstrType_REG, InstrType_IMM, InstrType_LOAD, InstrType_STORE
+};
+
+static int profileTypeOf(char type) {
+	switch(type) {
+	case InstrType_REG:
+		return ProfileType_REG;
+	case InstrType_IMM:
+		return ProfileType_IMM;
+	case InstrType_LOAD:
+		return ProfileType_LOAD;
+	default:
+		return ProfileType_STORE;
+	}
+}
+
+bool TraceProfile::build(TraceSource& source) {
+	memset(this, 0, sizeof(*this));
+	bool hasConfig = source.getConfig(config);
+	// Instruction number + 1 of the last writer of each register.
+	std::vector<InstrNum> lastWriter(hasConfig ? config.numArchRegs : 0, 0);
+	uint32_t storeBase[PROFILE_RECENT_STORES];
+	uint32_t storeImm[PROFILE_RECENT_STORES];
+	uint64_t numStores = 0;
+	int prevType = -1;
+	uint32_t maxReg = 0;
+
+	std::vector<StaticInstruction> batch(PROFILE_BATCH_SIZE);
+	while(size_t numRead = source.read(batch.data(), batch.size())) {
+		for(size_t i = 0; i < numRead; i++, numInstructions++) {
+			const StaticInstruction& inst = batch[i];
+			int type = profileTypeOf(inst.type);
+			typeCounts[type]++;
+			if(prevType >= 0)
+				transitions[prevType][type]++;
+			prevType = type;
+
+			// srcOp2 is -1 for I and L, the stored value for S.
+			uint32_t sources[2] = { inst.srcOp1, inst.srcOp2 };
+			for(int op = 0; op < 2; op++) {
+				if(sources[op] == (uint32_t) -1)
+					continue;
+				InstrNum writer = sources[op] < lastWriter.size() ? lastWriter[sources[op]] : 0;
+				InstrNum distance = writer ? numInstructions + 1 - writer : 0;
+				if(distance > PROFILE_MAX_DEPENDENCY_DISTANCE)
+					distance = 0;
+				dependencyDistances[type][op][distance]++;
+			}
+
+			if(type == ProfileType_LOAD) {
+				numLoads++;
+				for(uint64_t s = 0; s < numStores && s < PROFILE_RECENT_STORES; s++) {
+					if(storeBase[s] == inst.srcOp1 && storeImm[s] == inst.immediate) {
+						aliasedLoads++;
+						break;
+					}
+				}
+			}
+			else if(type == ProfileType_STORE) {
+				storeBase[numStores % PROFILE_RECENT_STORES] = inst.srcOp1;
+				storeImm[numStores % PROFILE_RECENT_STORES] = inst.immediate;
+				numStores++;
+			}
+
+			if(inst.dstOp != (uint32_t) -1) {
+				if(inst.dstOp >= lastWriter.size())
+					lastWriter.resize(inst.dstOp + 1, 0);
+				lastWriter[inst.dstOp] = numInstructions + 1;
+				maxReg = std::max(maxReg, inst.dstOp);
+			}
+		}
+	}
+	if(!hasConfig) {
+		config.numArchRegs = maxReg + 1;
+		config.numPhysicalRegs = 2 * config.numArchRegs;
+	}
+	return numInstructions > 0;
+}
+
+void TraceProfile::print(std::ostream& out) const {
+	out << numInstructions << " instructions:";
+	for(int t = 0; t < ProfileType_COUNT; t++)
+		out << " " << profileTypes[t] << "=" << typeCounts[t];
+	out << "\n";
+	for(int t = 0; t < ProfileType_COUNT; t++) {
+		for(int op = 0; op < 2; op++) {
+			uint64_t total = 0, sum = 0, none = dependencyDistances[t][op][0];
+			for(int d = 1; d <= PROFILE_MAX_DEPENDENCY_DISTANCE; d++) {
+				total += dependencyDistances[t][op][d];
+				sum += d * dependencyDistances[t][op][d];
+			}
+			if(total + none == 0)
+				continue;
+			out << "  " << profileTypes[t] << " operand " << op + 1 << ": mean distance " <<
+					(total ? (double) sum / total : 0) << ", no producer " <<
+					100.0 * none / (total + none) << "%\n";
+		}
+	}
+	out << "  loads aliasing a recent store: " <<
+			(numLoads ? 100.0 * aliasedLoads / numLoads : 0) << "%\n";
+}
+
+static uint64_t probabilityThreshold(double p) {
+	return p >= 1 ? 1ULL << 53 : (uint64_t) (p * (1ULL << 53));
+}
+
+// Cumulative thresholds of counts; all zero counts fall back to fallback.
+static void cumulativeThresholds(const uint64_t* counts, const uint64_t* fallback,
+		uint64_t* thresholds) {
+	uint64_t total = 0;
+	for(int t = 0; t < ProfileType_COUNT; t++)
+		total += counts[t];
+	if(total == 0) {
+		memcpy(thresholds, fallback, ProfileType_COUNT * sizeof(uint64_t));
+		return;
+	}
+	uint64_t sum = 0;
+	for(int t = 0; t < ProfileType_COUNT; t++) {
+		sum += counts[t];
+		thresholds[t] = probabilityThreshold((double) sum / total);
+	}
+}
+
+CloneTraceSource::CloneTraceSource(const TraceProfile& profile, InstrNum length, uint64_t seed) :
+	profile(profile), length(length), seed(seed) {
+	assert(profile.config.numArchRegs > 0);
+	const uint64_t uniform[ProfileType_COUNT] = { 1, 1, 1, 1 };
+	uint64_t uniformThresholds[ProfileType_COUNT];
+	cumulativeThresholds(uniform, uniformThresholds, uniformThresholds);
+	cumulativeThresholds(profile.typeCounts, uniformThresholds, initialThresholds);
+	for(int t = 0; t < ProfileType_COUNT; t++)
+		cumulativeThresholds(profile.transitions[t], initialThresholds, transitionThresholds[t]);
+
+	for(int t = 0; t < ProfileType_COUNT; t++) {
+		for(int op = 0; op < 2; op++) {
+			const uint64_t* counts = profile.dependencyDistances[t][op];
+			uint64_t total = 0;
+			for(int d = 0; d <= PROFILE_MAX_DEPENDENCY_DISTANCE; d++)
+				total += counts[d];
+			// Walk the histogram to find the distance at each quantile.
+			uint64_t cumulative = 0;
+			int d = 0;
+			for(int q = 0; q < NUM_DISTANCE_QUANTILES; q++) {
+				double target = (q + 0.5) / NUM_DISTANCE_QUANTILES * total;
+				while(d < PROFILE_MAX_DEPENDENCY_DISTANCE && cumulative + counts[d] <= target)
+					cumulative += counts[d++];
+				distanceQuantiles[t][op][q] = total ? d : 0;
+			}
+		}
+	}
+	aliasThreshold = probabilityThreshold(profile.numLoads ?
+			(double) profile.aliasedLoads / profile.numLoads : 0);
+	rewind();
+}
+
+// splitmix64
+uint64_t CloneTraceSource::nextRandom() {
+	uint64_t z = (rngState += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+int CloneTraceSource::sampleType(const uint64_t* thresholds) {
+	uint64_t r = nextRandom() >> 11;
+	int t = 0;
+	while(t < ProfileType_COUNT - 1 && r >= thresholds[t])
+		t++;
+	return t;
+}
+
+uint32_t CloneTraceSource::sourceRegister(int type, int operand) {
+	uint32_t distance = distanceQuantiles[type][operand][nextRandom() & (NUM_DISTANCE_QUANTILES - 1)];
+	// Stores write no register; take the next older writer instead.
+	for(; distance != 0 && distance <= pos && distance <= PROFILE_MAX_DEPENDENCY_DISTANCE; distance++) {
+		uint32_t producer = recentDst[(pos - distance) & RECENT_DST_MASK];
+		if(producer != (uint32_t) -1)
+			return producer;
+	}
+	// The next destination is the register written longest ago.
+	return nextDst;
+}
+
+size_t CloneTraceSource::read(StaticInstruction* batch, size_t maxCount) {
+	size_t count = 0;
+	for(; count < maxCount && pos < length; count++, pos++) {
+		int type = sampleType(prevType < 0 ? initialThresholds : transitionThresholds[prevType]);
+		prevType = type;
+		StaticInstruction& inst = batch[count];
+		inst.type = profileTypes[type];
+		inst.srcOp1 = sourceRegister(type, 0);
+		inst.srcOp2 = type == ProfileType_REG || type == ProfileType_STORE ?
+				sourceRegister(type, 1) : -1;
+		inst.immediate = type == ProfileType_REG ? -1 : nextRandom() & 0xff;
+		if(type == ProfileType_STORE) {
+			inst.dstOp = -1;
+			recentStoreBase[numRecentStores % PROFILE_RECENT_STORES] = inst.srcOp1;
+			recentStoreImm[numRecentStores % PROFILE_RECENT_STORES] = inst.immediate;
+			numRecentStores++;
+		}
+		else {
+			// Alias a recent store with the same base register, keeping the
+			// dependency distance just drawn.
+			if(type == ProfileType_LOAD && (nextRandom() >> 11) < aliasThreshold) {
+				uint64_t numStores = std::min<uint64_t>(numRecentStores, PROFILE_RECENT_STORES);
+				for(uint64_t s = 0; s < numStores; s++) {
+					if(recentStoreBase[s] == inst.srcOp1) {
+						inst.immediate = recentStoreImm[s];
+						break;
+					}
+				}
+			}
+			inst.dstOp = nextDst;
+			nextDst = (nextDst + 1) % profile.config.numArchRegs;
+		}
+		recentDst[pos & RECENT_DST_MASK] = inst.dstOp;
+	}
+	return count;
+}
+
+bool CloneTraceSource::rewind() {
+	rngState = seed;
+	pos = 0;
+	prevType = -1;
+	nextDst = 0;
+	numRecentStores = 0;
+	memset(recentDst, 0xff, sizeof(recentDst));
+	return true;
+}
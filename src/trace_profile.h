@@ -0,0 +1,88 @@
+#ifndef SRC_TRACE_PROFILE_H_
+#define SRC_TRACE_PROFILE_H_
+
+#include "trace_source.h"
+
+// Longest dependency distance told apart by a profile; farther producers
+// count as no producer.
+#define PROFILE_MAX_DEPENDENCY_DISTANCE 64
+// Stores a load is compared against for aliasing.
+#define PROFILE_RECENT_STORES 8
+
+enum ProfileType {
+	ProfileType_REG,
+	ProfileType_IMM,
+	ProfileType_LOAD,
+	ProfileType_STORE,
+	ProfileType_COUNT
+};
+
+/*
+ * Statistics of a trace that matter to the pipeline: which instruction
+ * type follows which, how far back the producer of each source operand
+ * is, and how often a load uses the base register and immediate of a
+ * recent store.
+ */
+struct TraceProfile {
+	CPUConfig config;
+	InstrNum numInstructions;
+	uint64_t typeCounts[ProfileType_COUNT];
+	// transitions[a][b]: instructions of type b right after one of type a.
+	uint64_t transitions[ProfileType_COUNT][ProfileType_COUNT];
+	// Per type and source operand (srcOp1, then srcOp2 for R and the
+	// stored value for S), how many instructions back the last writer of
+	// the register is; index 0 counts operands without one in range.
+	uint64_t dependencyDistances[ProfileType_COUNT][2][PROFILE_MAX_DEPENDENCY_DISTANCE + 1];
+	uint64_t numLoads;
+	uint64_t aliasedLoads;
+
+	// Reads source from its current position to the end.
+	bool build(TraceSource& source);
+	void print(std::ostream& out) const;
+};
+
+// Instructions drawn from a TraceProfile. Destinations rotate through
+// the registers so that a source can name the producer at any profiled
+// distance, and a source without a producer reads the register written
+// longest ago.
+class CloneTraceSource : public TraceSource {
+	const TraceProfile& profile;
+	InstrNum length;
+	uint64_t seed;
+	// Cumulative distributions scaled to 53-bit random numbers.
+	uint64_t initialThresholds[ProfileType_COUNT];
+	uint64_t transitionThresholds[ProfileType_COUNT][ProfileType_COUNT];
+	// Dependency distances at evenly spaced quantiles.
+	uint8_t distanceQuantiles[ProfileType_COUNT][2][4096];
+	uint64_t aliasThreshold;
+
+	uint64_t rngState;
+	InstrNum pos;
+	int prevType;
+	uint32_t nextDst;
+	// Destination of each recent instruction, -1 for stores.
+	uint32_t recentDst[2 * PROFILE_MAX_DEPENDENCY_DISTANCE];
+	uint32_t recentStoreBase[PROFILE_RECENT_STORES];
+	uint32_t recentStoreImm[PROFILE_RECENT_STORES];
+	uint64_t numRecentStores;
+
+	uint64_t nextRandom();
+	int sampleType(const uint64_t* thresholds);
+	uint32_t sourceRegister(int type, int operand);
+public:
+	CloneTraceSource(const TraceProfile& profile, InstrNum length, uint64_t seed);
+
+	size_t read(StaticInstruction* batch, size_t maxCount);
+	bool rewind();
+
+	InstrNum size() const {
+		return length;
+	}
+
+	bool getConfig(CPUConfig& config) const {
+		config = profile.config;
+		return true;
+	}
+};
+
+#endif /* SRC_TRACE_PROFILE_H_ */
@@ -0,0 +1,493 @@
+#include "trace_source.h"
+#include "compressed_trace.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#define BINARY_TRACE_MAGIC "R10KTRCE"
+#define BINARY_TRACE_MAGIC_LEN 8
+#define BINARY_TRACE_VERSION 1
+#define BINARY_TRACE_HEADER_SIZE 40
+#define BINARY_TRACE_COUNT_OFFSET 32
+#define TEXT_TRACE_BUFFER_SIZE (64 * 1024)
+#define BINARY_TRACE_WRITER_BUFFER_SIZE (1024 * 1024)
+#define TEXT_TRACE_WRITER_BUFFER_SIZE (1024 * 1024)
+// Decompression threads used by openTraceSource().
+#define COMPRESSED_TRACE_MAX_THREADS 4
+
+static void putFixed(std::string& buf, uint64_t value, int bytes) {
+	for(int i = 0; i < bytes; i++)
+		buf.push_back((char) ((value >> (8 * i)) & 0xff));
+}
+
+static uint64_t getFixed(const uint8_t* bytes, int size) {
+	uint64_t value = 0;
+	for(int i = 0; i < size; i++)
+		value |= (uint64_t) bytes[i] << (8 * i);
+	return value;
+}
+
+bool TraceSource::seek(InstrNum instrNumber) {
+	if(!rewind())
+		return false;
+	StaticInstruction batch[256];
+	while(instrNumber > 0) {
+		size_t numRead = read(batch, std::min<InstrNum>(instrNumber, 256));
+		if(numRead == 0)
+			return false;
+		instrNumber -= numRead;
+	}
+	return true;
+}
+
+void encodeTraceRecord(const StaticInstruction& inst, uint8_t* record) {
+	uint32_t fields[4];
+	fields[0] = (uint8_t) inst.type;
+	inst.encode(fields[1], fields[2], fields[3]);
+	for(int i = 0; i < 4; i++)
+		for(int b = 0; b < 4; b++)
+			record[4 * i + b] = (fields[i] >> (8 * b)) & 0xff;
+}
+
+bool decodeTraceRecord(const uint8_t* record, StaticInstruction& inst) {
+	uint64_t type = getFixed(record, 4);
+	if(type > 0x7f || !StaticInstruction::isValidType(type))
+		return false;
+	inst = StaticInstruction::decode(type, getFixed(record + 4, 4),
+			getFixed(record + 8, 4), getFixed(record + 12, 4));
+	return true;
+}
+
+MemoryTraceSource::MemoryTraceSource(const InstructionTrace& trace) :
+	trace(trace), pos(0) {
+}
+
+size_t MemoryTraceSource::read(StaticInstruction* batch, size_t maxCount) {
+	size_t count = 0;
+	for(; count < maxCount && pos < trace.size(); count++)
+		batch[count] = trace[pos++];
+	return count;
+}
+
+bool MemoryTraceSource::rewind() {
+	pos = 0;
+	return true;
+}
+
+bool MemoryTraceSource::seek(InstrNum instrNumber) {
+	if(instrNumber > trace.size())
+		return false;
+	pos = instrNumber;
+	return true;
+}
+
+TextTraceSource::TextTraceSource() :
+	buffer(TEXT_TRACE_BUFFER_SIZE), bufferPos(0), bufferEnd(0),
+	numParsed(0), ended(true) {
+	memset(&config, 0, sizeof(config));
+}
+
+TextTraceSource::~TextTraceSource() {
+}
+
+bool TextTraceSource::open(std::string path) {
+	this->path = path;
+	file.open(path, std::ios::binary);
+	if(!file.is_open()) {
+		std::cerr << "Cannot open input file " << path << "\n";
+		return false;
+	}
+	return start();
+}
+
+size_t TextTraceSource::readBytes(char* bytes, size_t size) {
+	file.read(bytes, size);
+	return file.gcount();
+}
+
+bool TextTraceSource::rewindBytes() {
+	file.clear();
+	file.seekg(0);
+	return file.good();
+}
+
+bool TextTraceSource::refill() {
+	bufferPos = 0;
+	bufferEnd = readBytes(buffer.data(), buffer.size());
+	return bufferEnd != 0;
+}
+
+int TextTraceSource::skipSpaces() {
+	int c = nextChar();
+	while(c == ' ' || c == '\t' || c == '\n' || c == '\r')
+		c = nextChar();
+	return c;
+}
+
+// Same as reading a uint32_t with >>, which also takes -1.
+bool TextTraceSource::parseNumber(uint32_t& value) {
+	int c = skipSpaces();
+	bool negative = c == '-';
+	if(negative)
+		c = nextChar();
+	if(c < '0' || c > '9')
+		return false;
+	value = 0;
+	while(c >= '0' && c <= '9') {
+		value = value * 10 + (c - '0');
+		c = nextChar();
+	}
+	// Leave the character after the number for the next token.
+	if(c != -1)
+		bufferPos--;
+	if(negative)
+		value = -value;
+	return true;
+}
+
+bool TextTraceSource::start() {
+	bufferPos = bufferEnd = 0;
+	numParsed = 0;
+	ended = true;
+	uint32_t* fields[] = { &config.numArchRegs, &config.numPhysicalRegs,
+			&config.robEntries, &config.width, &config.numLSQEntries };
+	for(int i = 0; i < 5; i++) {
+		if(!parseNumber(*fields[i])) {
+			std::cerr << path << ": no configuration line\n";
+			return false;
+		}
+	}
+	ended = false;
+	return true;
+}
+
+size_t TextTraceSource::read(StaticInstruction* batch, size_t maxCount) {
+	size_t count = 0;
+	while(count < maxCount && !ended) {
+		int type = skipSpaces();
+		if(type == -1) {
+			ended = true;
+			break;
+		}
+		uint32_t srcOp1, srcOp2, dstOp;
+		if(!parseNumber(srcOp1) || !parseNumber(srcOp2) || !parseNumber(dstOp)) {
+			std::cerr << path << ": truncated instruction " << numParsed << "\n";
+			ended = true;
+			break;
+		}
+		if(!StaticInstruction::isValidType(type)) {
+			std::cerr << path << ": unsupported type " << (char) type <<
+					" of instruction " << numParsed << "\n";
+			ended = true;
+			break;
+		}
+		batch[count++] = StaticInstruction::decode(type, srcOp1, srcOp2, dstOp);
+		numParsed++;
+	}
+	return count;
+}
+
+bool TextTraceSource::rewind() {
+	return rewindBytes() && start();
+}
+
+bool TextTraceSource::getConfig(CPUConfig& config) const {
+	config = this->config;
+	return true;
+}
+
+GzipTraceSource::GzipTraceSource() : gz(nullptr) {
+}
+
+GzipTraceSource::~GzipTraceSource() {
+	if(gz)
+		gzclose(gz);
+}
+
+bool GzipTraceSource::open(std::string path) {
+	this->path = path;
+	gz = gzopen(path.c_str(), "rb");
+	if(gz == nullptr) {
+		std::cerr << "Cannot open input file " << path << "\n";
+		return false;
+	}
+	gzbuffer(gz, TEXT_TRACE_BUFFER_SIZE);
+	return start();
+}
+
+size_t GzipTraceSource::readBytes(char* bytes, size_t size) {
+	int count = gzread(gz, bytes, size);
+	if(count < 0) {
+		int errnum;
+		std::cerr << path << ": " << gzerror(gz, &errnum) << "\n";
+		return 0;
+	}
+	return count;
+}
+
+bool GzipTraceSource::rewindBytes() {
+	return gzrewind(gz) == 0;
+}
+
+BinaryTraceSource::BinaryTraceSource() :
+	data(nullptr), dataSize(0), numInstructions(0), pos(0) {
+	memset(&config, 0, sizeof(config));
+}
+
+BinaryTraceSource::~BinaryTraceSource() {
+	if(data)
+		munmap((void*) data, dataSize);
+}
+
+bool BinaryTraceSource::open(std::string path) {
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if(fd < 0) {
+		std::cerr << "Cannot open input file " << path << "\n";
+		return false;
+	}
+	struct stat st;
+	if(fstat(fd, &st) != 0 || st.st_size < BINARY_TRACE_HEADER_SIZE) {
+		std::cerr << path << ": not a binary trace\n";
+		close(fd);
+		return false;
+	}
+	dataSize = st.st_size;
+	void* mapped = mmap(nullptr, dataSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(mapped == MAP_FAILED) {
+		std::cerr << path << ": cannot map the trace\n";
+		dataSize = 0;
+		return false;
+	}
+	data = (const uint8_t*) mapped;
+	madvise(mapped, dataSize, MADV_SEQUENTIAL);
+
+	if(memcmp(data, BINARY_TRACE_MAGIC, BINARY_TRACE_MAGIC_LEN) != 0 ||
+			getFixed(data + BINARY_TRACE_MAGIC_LEN, 4) != BINARY_TRACE_VERSION) {
+		std::cerr << path << ": not a version " << BINARY_TRACE_VERSION << " binary trace\n";
+		return false;
+	}
+	uint32_t* fields[] = { &config.numArchRegs, &config.numPhysicalRegs,
+			&config.robEntries, &config.width, &config.numLSQEntries };
+	for(int i = 0; i < 5; i++)
+		*fields[i] = getFixed(data + 12 + 4 * i, 4);
+	numInstructions = getFixed(data + BINARY_TRACE_COUNT_OFFSET, 8);
+	if((dataSize - BINARY_TRACE_HEADER_SIZE) / TRACE_RECORD_SIZE < numInstructions) {
+		std::cerr << path << ": truncated binary trace\n";
+		numInstructions = 0;
+		return false;
+	}
+	pos = 0;
+	return true;
+}
+
+size_t BinaryTraceSource::read(StaticInstruction* batch, size_t maxCount) {
+	size_t count = 0;
+	const uint8_t* record = data + BINARY_TRACE_HEADER_SIZE + pos * TRACE_RECORD_SIZE;
+	for(; count < maxCount && pos < numInstructions; count++) {
+		if(!decodeTraceRecord(record, batch[count])) {
+			std::cerr << "Unsupported type " << getFixed(record, 4) << " of instruction " << pos << "\n";
+			numInstructions = pos;
+			break;
+		}
+		record += TRACE_RECORD_SIZE;
+		pos++;
+	}
+	return count;
+}
+
+bool BinaryTraceSource::rewind() {
+	return seek(0);
+}
+
+bool BinaryTraceSource::seek(InstrNum instrNumber) {
+	if(data == nullptr || instrNumber > numInstructions)
+		return false;
+	pos = instrNumber;
+	return true;
+}
+
+bool BinaryTraceSource::getConfig(CPUConfig& config) const {
+	config = this->config;
+	return true;
+}
+
+BinaryTraceWriter::BinaryTraceWriter() :
+	buffer(BINARY_TRACE_WRITER_BUFFER_SIZE), bufferUsed(0), numInstructions(0) {
+}
+
+BinaryTraceWriter::~BinaryTraceWriter() {
+}
+
+bool BinaryTraceWriter::open(std::string path, const CPUConfig& config) {
+	out.open(path, std::ios::binary);
+	if(!out.is_open()) {
+		std::cerr << "Cannot open trace file " << path << " to write!\n";
+		return false;
+	}
+	std::string header(BINARY_TRACE_MAGIC);
+	putFixed(header, BINARY_TRACE_VERSION, 4);
+	putFixed(header, config.numArchRegs, 4);
+	putFixed(header, config.numPhysicalRegs, 4);
+	putFixed(header, config.robEntries, 4);
+	putFixed(header, config.width, 4);
+	putFixed(header, config.numLSQEntries, 4);
+	// Patched by close().
+	putFixed(header, 0, 8);
+	out.write(header.data(), header.size());
+	bufferUsed = 0;
+	numInstructions = 0;
+	return true;
+}
+
+void BinaryTraceWriter::flush() {
+	out.write((const char*) buffer.data(), bufferUsed);
+	bufferUsed = 0;
+}
+
+void BinaryTraceWriter::addInstruction(const StaticInstruction& inst) {
+	encodeTraceRecord(inst, &buffer[bufferUsed]);
+	bufferUsed += TRACE_RECORD_SIZE;
+	numInstructions++;
+	if(bufferUsed == buffer.size())
+		flush();
+}
+
+bool BinaryTraceWriter::close() {
+	flush();
+	std::string count;
+	putFixed(count, numInstructions, 8);
+	out.seekp(BINARY_TRACE_COUNT_OFFSET);
+	out.write(count.data(), count.size());
+	out.close();
+	return !out.fail();
+}
+
+static void appendNumber(std::string& out, uint32_t value) {
+	char digits[10];
+	int n = 0;
+	do {
+		digits[n++] = '0' + value % 10;
+		value /= 10;
+	} while(value);
+	while(n)
+		out.push_back(digits[--n]);
+}
+
+TextTraceWriter::TextTraceWriter() : out(nullptr), failed(false) {
+}
+
+TextTraceWriter::~TextTraceWriter() {
+	if(out)
+		fclose(out);
+}
+
+bool TextTraceWriter::open(std::string path, const CPUConfig& config) {
+	out = fopen(path.c_str(), "w");
+	if(out == nullptr) {
+		std::cerr << "Cannot open trace file " << path << " to write!\n";
+		return false;
+	}
+	failed = false;
+	buffer.clear();
+	buffer.reserve(TEXT_TRACE_WRITER_BUFFER_SIZE + 64);
+	const uint32_t fields[] = { config.numArchRegs, config.numPhysicalRegs,
+			config.robEntries, config.width, config.numLSQEntries };
+	for(int i = 0; i < 5; i++) {
+		appendNumber(buffer, fields[i]);
+		buffer.push_back(i + 1 < 5 ? ' ' : '\n');
+	}
+	return true;
+}
+
+void TextTraceWriter::flush() {
+	// After a short write, e.g. on a full disk, the rest is dropped.
+	if(!failed && fwrite(buffer.data(), 1, buffer.size(), out) != buffer.size())
+		failed = true;
+	buffer.clear();
+}
+
+void TextTraceWriter::addInstruction(const StaticInstruction& inst) {
+	uint32_t srcOp1, srcOp2, dstOp;
+	inst.encode(srcOp1, srcOp2, dstOp);
+	buffer.push_back(inst.type);
+	buffer.push_back(' ');
+	appendNumber(buffer, srcOp1);
+	buffer.push_back(' ');
+	appendNumber(buffer, srcOp2);
+	buffer.push_back(' ');
+	appendNumber(buffer, dstOp);
+	buffer.push_back('\n');
+	if(buffer.size() >= TEXT_TRACE_WRITER_BUFFER_SIZE)
+		flush();
+}
+
+bool TextTraceWriter::close() {
+	flush();
+	bool ok = !failed && !ferror(out);
+	ok = fclose(out) == 0 && ok;
+	out = nullptr;
+	return ok;
+}
+
+bool detectTraceFormat(std::string path, TraceFormat& format) {
+	std::ifstream in(path, std::ios::binary);
+	if(!in.is_open()) {
+		std::cerr << "Cannot open input file " << path << "\n";
+		return false;
+	}
+	char magic[BINARY_TRACE_MAGIC_LEN] = {0};
+	in.read(magic, BINARY_TRACE_MAGIC_LEN);
+	if(memcmp(magic, BINARY_TRACE_MAGIC, BINARY_TRACE_MAGIC_LEN) == 0)
+		format = TraceFormat_BINARY;
+	else if(memcmp(magic, COMPRESSED_TRACE_MAGIC, BINARY_TRACE_MAGIC_LEN) == 0)
+		format = TraceFormat_COMPRESSED;
+	else if((uint8_t) magic[0] == 0x1f && (uint8_t) magic[1] == 0x8b)
+		format = TraceFormat_GZIP;
+	else
+		format = TraceFormat_TEXT;
+	return true;
+}
+
+TraceSource* openTraceSource(std::string path) {
+	TraceFormat format;
+	if(!detectTraceFormat(path, format))
+		return nullptr;
+	switch(format) {
+	case TraceFormat_BINARY: {
+		BinaryTraceSource* source = new BinaryTraceSource();
+		if(source->open(path))
+			return source;
+		delete source;
+		break;
+	}
+	case TraceFormat_COMPRESSED: {
+		CompressedTraceSource* source = new CompressedTraceSource();
+		unsigned numThreads = std::min(std::thread::hardware_concurrency(),
+				(unsigned) COMPRESSED_TRACE_MAX_THREADS);
+		if(source->open(path, numThreads))
+			return source;
+		delete source;
+		break;
+	}
+	case TraceFormat_GZIP: {
+		GzipTraceSource* source = new GzipTraceSource();
+		if(source->open(path))
+			return source;
+		delete source;
+		break;
+	}
+	case TraceFormat_TEXT: {
+		TextTraceSource* source = new TextTraceSource();
+		if(source->open(path))
+			return source;
+		delete source;
+		break;
+	}
+	}
+	return nullptr;
+}
@@ -0,0 +1,207 @@
+#ifndef SRC_TRACE_SOURCE_H_
+#define SRC_TRACE_SOURCE_H_
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "cpu_config.h"
+#include "instruction_trace.h"
+#include "utils.h"
+
+// size() of a source that does not know its length up front.
+#define TRACE_SIZE_UNKNOWN UINT64_MAX
+
+// Bytes per instruction in binary and compressed traces.
+#define TRACE_RECORD_SIZE 16
+
+/*
+ * Where the CPU gets its instructions from. Sources deliver instructions
+ * in program order, in batches, so that a trace never has to be held in
+ * memory as a whole. Errors are reported on std::cerr and end the trace.
+ */
+class TraceSource {
+public:
+	virtual ~TraceSource() {
+	}
+
+	// Copies up to maxCount next instructions to batch and returns how
+	// many were copied; 0 once the trace has ended.
+	virtual size_t read(StaticInstruction* batch, size_t maxCount) = 0;
+	// Goes back to the first instruction.
+	virtual bool rewind() = 0;
+	// Continues reading at instruction instrNumber. Reads its way there
+	// from the start unless the format allows random access.
+	virtual bool seek(InstrNum instrNumber);
+
+	// Number of instructions, or TRACE_SIZE_UNKNOWN.
+	virtual InstrNum size() const {
+		return TRACE_SIZE_UNKNOWN;
+	}
+
+	// The configuration line stored with the trace, if the format has one.
+	virtual bool getConfig(CPUConfig& config) const {
+		return false;
+	}
+};
+
+// Reads an InstructionTrace, which may keep growing while it is read.
+class MemoryTraceSource : public TraceSource {
+	const InstructionTrace& trace;
+	InstrNum pos;
+public:
+	MemoryTraceSource(const InstructionTrace& trace);
+
+	size_t read(StaticInstruction* batch, size_t maxCount);
+	bool rewind();
+	bool seek(InstrNum instrNumber);
+
+	InstrNum size() const {
+		return trace.size();
+	}
+};
+
+/*
+ * Streams an input file such as inputs/ex1.txt. Parses straight from a
+ * byte buffer; subclasses only provide the bytes.
+ */
+class TextTraceSource : public TraceSource {
+	std::ifstream file;
+	std::vector<char> buffer;
+	size_t bufferPos;
+	size_t bufferEnd;
+	CPUConfig config;
+	InstrNum numParsed;
+	// Set at the end of the bytes and on parse errors.
+	bool ended;
+
+	bool refill();
+	int nextChar() {
+		if(bufferPos == bufferEnd && !refill())
+			return -1;
+		return (unsigned char) buffer[bufferPos++];
+	}
+	int skipSpaces();
+	bool parseNumber(uint32_t& value);
+protected:
+	std::string path;
+
+	virtual size_t readBytes(char* bytes, size_t size);
+	virtual bool rewindBytes();
+	// Parses the configuration line once the bytes are available.
+	bool start();
+public:
+	TextTraceSource();
+	virtual ~TextTraceSource();
+
+	bool open(std::string path);
+
+	size_t read(StaticInstruction* batch, size_t maxCount);
+	bool rewind();
+	bool getConfig(CPUConfig& config) const;
+};
+
+// A gzip-compressed input file, e.g. inputs/ex1.txt.gz.
+class GzipTraceSource : public TextTraceSource {
+	struct gzFile_s* gz;
+protected:
+	size_t readBytes(char* bytes, size_t size);
+	bool rewindBytes();
+public:
+	GzipTraceSource();
+	virtual ~GzipTraceSource();
+
+	bool open(std::string path);
+};
+
+/*
+ * Binary trace, mapped into memory:
+ *
+ *   "R10KTRCE" | version | config | #instructions
+ *   then one 16-byte record per instruction: type, srcOp1, srcOp2 and
+ *   dstOp as written in the text format.
+ *
+ * All fields are little-endian 32-bit words except #instructions, which
+ * is 64 bits wide.
+ */
+class BinaryTraceSource : public TraceSource {
+	const uint8_t* data;
+	size_t dataSize;
+	CPUConfig config;
+	InstrNum numInstructions;
+	InstrNum pos;
+public:
+	BinaryTraceSource();
+	virtual ~BinaryTraceSource();
+	BinaryTraceSource(const BinaryTraceSource&) = delete;
+	BinaryTraceSource& operator=(const BinaryTraceSource&) = delete;
+
+	bool open(std::string path);
+
+	size_t read(StaticInstruction* batch, size_t maxCount);
+	bool rewind();
+	bool seek(InstrNum instrNumber);
+
+	InstrNum size() const {
+		return numInstructions;
+	}
+
+	bool getConfig(CPUConfig& config) const;
+};
+
+// The record of one instruction in binary and compressed traces.
+void encodeTraceRecord(const StaticInstruction& inst, uint8_t* record);
+// Fails on unknown instruction types.
+bool decodeTraceRecord(const uint8_t* record, StaticInstruction& inst);
+
+// Writes the format read by BinaryTraceSource one instruction at a time.
+class BinaryTraceWriter {
+	std::ofstream out;
+	std::vector<uint8_t> buffer;
+	size_t bufferUsed;
+	InstrNum numInstructions;
+
+	void flush();
+public:
+	BinaryTraceWriter();
+	virtual ~BinaryTraceWriter();
+
+	bool open(std::string path, const CPUConfig& config);
+	void addInstruction(const StaticInstruction& inst);
+	// Fills in the instruction count; returns false on write errors.
+	bool close();
+};
+
+// Writes an input file such as inputs/ex1.txt one instruction at a time.
+class TextTraceWriter {
+	FILE* out;
+	std::string buffer;
+	// A write fell short.
+	bool failed;
+
+	void flush();
+public:
+	TextTraceWriter();
+	virtual ~TextTraceWriter();
+
+	bool open(std::string path, const CPUConfig& config);
+	void addInstruction(const StaticInstruction& inst);
+	// Returns false if any write failed.
+	bool close();
+};
+
+enum TraceFormat {
+	TraceFormat_TEXT,
+	TraceFormat_GZIP,
+	TraceFormat_BINARY,
+	TraceFormat_COMPRESSED
+};
+
+// Tells the formats above apart by their first bytes.
+bool detectTraceFormat(std::string path, TraceFormat& format);
+// Opens path in the format it was written in. Returns nullptr on errors;
+// the caller owns the source.
+TraceSource* openTraceSource(std::string path);
+
+#endif /* SRC_TRACE_SOURCE_H_ */
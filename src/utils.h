@@ -12,6 +12,28 @@
 #define InstrType_IMM 'I'
 #define InstrType_LOAD 'L'
 #define InstrType_STORE 'S'
+#define NUM_INSTR_TYPES 4
+
+// Position of an instruction type in per-type tables, in the order above.
+inline int getInstrTypeIndex(char type) {
+	switch(type) {
+	case InstrType_REG:
+		return 0;
+	case InstrType_IMM:
+		return 1;
+	case InstrType_LOAD:
+		return 2;
+	default:
+		return 3;
+	}
+}
+
+inline char getInstrType(int index) {
+	static const char types[NUM_INSTR_TYPES] = {
+		InstrType_REG, InstrType_IMM, InstrType_LOAD, InstrType_STORE
+	};
+	return types[index];
+}
 
 enum RSType {
 	RSType_ALU,
@@ -20,4 +42,45 @@ enum RSType {
 	RSType_UNKNOWN
 };
 
+// Cycles and instruction numbers are 64-bit so that billion-instruction
+// traces at low IPC cannot wrap around.
+typedef uint64_t Cycle;
+typedef uint64_t InstrNum;
+
+// Value reported for a stage the instruction has not reached yet.
+#define CYCLE_UNSET UINT64_MAX
+// Instruction number standing for no instruction.
+#define INSTR_NONE UINT64_MAX
+
+// Pipeline stages in the order their timestamps appear in the output file.
+enum TimingStage {
+	Stage_FETCH,
+	Stage_DECODE,
+	Stage_DISPATCH,
+	Stage_ISSUE,
+	Stage_EXECUTE,
+	Stage_COMPLETE,
+	Stage_RETIRE,
+	Stage_COUNT
+};
+
+inline const char* getStageName(TimingStage stage) {
+	static const char* names[Stage_COUNT] = {
+		"fetch", "decode", "dispatch", "issue", "execute", "complete", "retire"
+	};
+	return names[stage];
+}
+
+// FNV-1a, used to fingerprint the instruction trace.
+#define FNV1A_OFFSET_BASIS 14695981039346656037ULL
+#define FNV1A_PRIME 1099511628211ULL
+
+inline uint64_t fnv1aUpdate(uint64_t hash, uint32_t value) {
+	for(int i = 0; i < 4; i++) {
+		hash ^= (value >> (8 * i)) & 0xff;
+		hash *= FNV1A_PRIME;
+	}
+	return hash;
+}
+
 #endif /* SRC_UTILS_H_ */
@@ -0,0 +1,37 @@
+#include "window_stats.h"
+
+#include <iomanip>
+
+WindowStats::WindowStats() {
+}
+
+WindowStats::~WindowStats() {
+}
+
+void WindowStats::clear() {
+	ready.clear();
+	depth.clear();
+	occupancy.clear();
+}
+
+void WindowStats::write(std::ostream& out) const {
+	const char* names[3] = { "ready to issue", "dependency depth", "RoB occupancy" };
+	const Histogram* histograms[3] = { &ready, &depth, &occupancy };
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	out << std::fixed << std::setprecision(2);
+	out << std::left << std::setw(18) << "per cycle" << std::right << std::setw(10) << "mean" <<
+			std::setw(8) << "p50" << std::setw(8) << "p90" << std::setw(8) << "max" << "\n";
+	for(int i = 0; i < 3; i++) {
+		out << std::left << std::setw(18) << names[i] << std::right << std::setw(10) <<
+				histograms[i]->getMean() << std::setw(8) << histograms[i]->getPercentile(0.5) <<
+				std::setw(8) << histograms[i]->getPercentile(0.9) << std::setw(8) <<
+				histograms[i]->getMax() << "\n";
+	}
+	out << "\nready to issue, cycles:\n";
+	ready.write(out, "  ");
+	out << "dependency depth, cycles:\n";
+	depth.write(out, "  ");
+	out.flags(flags);
+	out.precision(precision);
+}
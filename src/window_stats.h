@@ -0,0 +1,48 @@
+#ifndef SRC_WINDOW_STATS_H_
+#define SRC_WINDOW_STATS_H_
+
+#include <ostream>
+
+#include "histogram.h"
+#include "utils.h"
+
+/*
+ * How much parallelism the instruction window holds, sampled every cycle
+ * just before issue (see BasicCPU::setWindowStats()):
+ *
+ *  - ready: dispatched instructions whose operands are all ready but that
+ *    have not issued, i.e. what issue can choose from;
+ *  - depth: the longest chain of dependent instructions in the RoB that
+ *    have not completed, counted in instructions.
+ *
+ * Many cycles with few ready instructions and a deep chain point at chain
+ * latency; a full RoB with shallow chains points at window size.
+ */
+class WindowStats {
+	Histogram ready;
+	Histogram depth;
+	Histogram occupancy;
+public:
+	WindowStats();
+	virtual ~WindowStats();
+
+	void clear();
+
+	void add(uint32_t numReady, uint32_t chainDepth, uint32_t robOccupancy) {
+		ready.add(numReady);
+		depth.add(chainDepth);
+		occupancy.add(robOccupancy);
+	}
+
+	const Histogram& getReady() const {
+		return ready;
+	}
+
+	const Histogram& getDepth() const {
+		return depth;
+	}
+
+	void write(std::ostream& out) const;
+};
+
+#endif /* SRC_WINDOW_STATS_H_ */
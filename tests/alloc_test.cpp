@@ -0,0 +1,123 @@
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include "cpu.h"
+
+// Fails if CPU::tick() touches the heap once the simulation has warmed up.
+
+static uint64_t numAllocations = 0;
+
+void* operator new(size_t size) {
+	numAllocations++;
+	void* ptr = malloc(size ? size : 1);
+	if(ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	free(ptr);
+}
+
+#define NUM_INSTRUCTIONS 200000
+#define WARMUP_CYCLES 1000
+// Stores that grow with the trace when its length is unknown: the timing
+// history, the stall history, the slack stats, the dispatch stalls per
+// decode cycle and the trace buffer. Each may double once per power of two.
+#define NUM_GROWING 5
+#define LOG2_NUM_INSTRUCTIONS 18
+
+// A source that does not tell its length, as a streamed trace.
+class StreamedTraceSource : public MemoryTraceSource {
+public:
+	StreamedTraceSource(const InstructionTrace& trace) : MemoryTraceSource(trace) {
+	}
+
+	InstrNum size() const {
+		return TRACE_SIZE_UNKNOWN;
+	}
+};
+
+// Runs cpu to the end after warming up; false if it allocated more than
+// maxAllocations times after the warmup.
+static bool check(const char* name, CPU& cpu, uint64_t maxAllocations) {
+	for(int i = 0; i < WARMUP_CYCLES && !cpu.isFinished(); i++)
+		cpu.tick();
+	if(cpu.isFinished()) {
+		std::cout << "alloc_test: " << name << ": trace finished during warmup\n";
+		return false;
+	}
+
+	uint64_t allocationsBefore = numAllocations;
+	uint64_t cycles = 0;
+	while(!cpu.isFinished()) {
+		cpu.tick();
+		cycles++;
+	}
+	uint64_t allocations = numAllocations - allocationsBefore;
+	if(allocations > maxAllocations) {
+		std::cout << "alloc_test: " << name << ": FAILED, " << allocations << " allocations in " <<
+				cycles << " cycles after warmup\n";
+		return false;
+	}
+	std::cout << "alloc_test: " << name << ": passed, " << allocations << " allocations in " <<
+			cycles << " cycles\n";
+	return true;
+}
+
+int main() {
+	// A loop body with short dependency chains through a handful of
+	// registers, plus independent loads and stores.
+	const char types[] = { 'L', 'R', 'I', 'S', 'R', 'L', 'I', 'R' };
+	InstructionTrace trace;
+	for(uint32_t i = 0; i < NUM_INSTRUCTIONS; i++) {
+		uint32_t reg = i % 8;
+		trace.addInstruction(types[i % 8], reg, (reg + 1) % 8, (reg + 2) % 8);
+	}
+	CPUConfig config = { 32, 64, 128, 2, 16 };
+	bool ok = true;
+
+	// The length is known, so nothing grows once warmed up.
+	CPU plain(config);
+	plain.setDebugLog(nullptr);
+	plain.setTrace(trace);
+	ok = check("plain", plain, 0) && ok;
+
+	// Neither do the analyses that are kept per instruction.
+	CPU analysed(config);
+	analysed.setDebugLog(nullptr);
+	analysed.setTrace(trace);
+	LatencyStats latencyStats;
+	RegisterHotSpots registerHotSpots;
+	WindowStats windowStats;
+	SlackStats slackStats(config);
+	analysed.setLatencyStats(&latencyStats);
+	analysed.setRegisterHotSpots(&registerHotSpots);
+	analysed.setWindowStats(&windowStats);
+	analysed.setSlackStats(&slackStats);
+	ok = check("analyses", analysed, 0) && ok;
+
+	// Streamed, and with stall attribution, whose dispatch stalls per
+	// decode cycle grow with the lead of the front end, what grows does
+	// so geometrically.
+	StreamedTraceSource source(trace);
+	CPU streamed(config);
+	streamed.setDebugLog(nullptr);
+	streamed.setTraceSource(&source);
+	LatencyStats streamedLatencyStats;
+	SlackStats streamedSlackStats(config);
+	streamed.setStallAttribution(true);
+	streamed.setLatencyStats(&streamedLatencyStats);
+	streamed.setSlackStats(&streamedSlackStats);
+	ok = check("streamed", streamed, NUM_GROWING * LOG2_NUM_INSTRUCTIONS) && ok;
+	return ok ? 0 : 1;
+}
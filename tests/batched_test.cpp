@@ -0,0 +1,150 @@
+#include <iostream>
+
+#include "batched_cpu.h"
+#include "parallel_runner.h"
+#include "synthetic_trace.h"
+
+// Checks that every lane of a BatchedCPU, and every configuration of a
+// ParallelRunner, gives exactly the timings and stats of a CPU of its own.
+
+#define NUM_INSTRUCTIONS 20000
+#define NUM_ARCH_REGS 32
+
+// A source that does not tell its length, as a streamed trace.
+class StreamedTraceSource : public SyntheticTraceSource {
+public:
+	StreamedTraceSource(const SyntheticTraceParams& params) : SyntheticTraceSource(params) {
+	}
+
+	InstrNum size() const {
+		return TRACE_SIZE_UNKNOWN;
+	}
+};
+
+// How much of a streamed trace has been read depends on how far the other
+// lanes got, so the length is only compared once it is known.
+static bool sameStats(const CPUStats& a, const CPUStats& b) {
+	return a.cycles == b.cycles && a.fetched == b.fetched && a.retired == b.retired &&
+			a.finished == b.finished && a.stuck == b.stuck &&
+			(!a.finished || a.instructions == b.instructions);
+}
+
+static void printConfig(const CPUConfig& config) {
+	std::cout << config.numArchRegs << "," << config.numPhysicalRegs << "," <<
+			config.robEntries << "," << config.width;
+}
+
+// Runs every configuration on a CPU of its own and compares.
+static bool compare(const char* name, const std::vector<CPUConfig>& configs,
+		TraceSource* source, const BatchedCPU& batch) {
+	for(size_t lane = 0; lane < configs.size(); lane++) {
+		CPU cpu(configs[lane]);
+		cpu.setDebugLog(nullptr);
+		cpu.setTraceSource(source);
+		cpu.simulate();
+		CPUStats expected = cpu.getStats();
+		CPUStats stats = batch.getStats(lane);
+		if(!sameStats(stats, expected)) {
+			std::cout << "batched_test: " << name << ": FAILED, ";
+			printConfig(configs[lane]);
+			std::cout << " took " << stats.cycles << " cycles to retire " << stats.retired <<
+					", not " << expected.cycles << " to retire " << expected.retired << "\n";
+			return false;
+		}
+		TimingFile a;
+		TimingFile b;
+		batch.collectTimings(lane, a);
+		cpu.collectTimings(b);
+		const std::vector<TimingRow>& rows = a.getRows();
+		const std::vector<TimingRow>& expectedRows = b.getRows();
+		if(stats.finished && rows.size() != expectedRows.size()) {
+			std::cout << "batched_test: " << name << ": FAILED, ";
+			printConfig(configs[lane]);
+			std::cout << " has " << rows.size() << " rows, not " << expectedRows.size() << "\n";
+			return false;
+		}
+		for(InstrNum i = 0; i < std::min(rows.size(), expectedRows.size()); i++) {
+			for(int s = 0; s < Stage_COUNT; s++) {
+				if(rows[i].cycles[s] == expectedRows[i].cycles[s])
+					continue;
+				std::cout << "batched_test: " << name << ": FAILED, ";
+				printConfig(configs[lane]);
+				std::cout << " instruction " << i << " entered " << getStageName((TimingStage) s) <<
+						" in cycle " << rows[i].cycles[s] << ", not " << expectedRows[i].cycles[s] << "\n";
+				return false;
+			}
+		}
+	}
+	std::cout << "batched_test: " << name << ": passed, " << configs.size() << " lanes\n";
+	return true;
+}
+
+static bool check(const char* name, uint32_t width, TraceSource* source, Cycle chunkCycles) {
+	std::vector<CPUConfig> configs;
+	const uint32_t robEntries[] = { 1, 2, 8, 32, 128 };
+	// Without a register beyond the architectural ones nothing that
+	// writes one can dispatch, so those lanes get stuck.
+	const uint32_t extraRegs[] = { 0, 1, 8, 64 };
+	for(uint32_t rob : robEntries) {
+		for(uint32_t extra : extraRegs)
+			configs.push_back(CPUConfig { NUM_ARCH_REGS, NUM_ARCH_REGS + extra, rob, width, 16 });
+	}
+	BatchedCPU batch(configs);
+	batch.setTraceSource(source);
+	batch.setTimingHistory(true);
+	while(batch.step(chunkCycles))
+		;
+	return compare(name, configs, source, batch);
+}
+
+// Mixed widths make several batches, over threads.
+static bool checkRunner(TraceSource* source) {
+	std::vector<CPUConfig> configs;
+	for(uint32_t width = 1; width <= 4; width++) {
+		configs.push_back(CPUConfig { NUM_ARCH_REGS, NUM_ARCH_REGS + 16, 16, width, 16 });
+		configs.push_back(CPUConfig { NUM_ARCH_REGS, NUM_ARCH_REGS + 48, 64, width, 16 });
+	}
+	ParallelRunner runner(configs, source);
+	runner.setNumThreads(3);
+	runner.simulate();
+	for(size_t i = 0; i < configs.size(); i++) {
+		CPU cpu(configs[i]);
+		cpu.setDebugLog(nullptr);
+		cpu.setTraceSource(source);
+		cpu.simulate();
+		if(!sameStats(runner.getStats(i), cpu.getStats())) {
+			std::cout << "batched_test: runner: FAILED, ";
+			printConfig(configs[i]);
+			std::cout << " took " << runner.getStats(i).cycles << " cycles, not " <<
+					cpu.getStats().cycles << "\n";
+			return false;
+		}
+	}
+	std::cout << "batched_test: runner: passed, " << configs.size() << " configurations\n";
+	return true;
+}
+
+int main() {
+	SyntheticTraceParams params;
+	params.length = NUM_INSTRUCTIONS;
+	params.numArchRegs = NUM_ARCH_REGS;
+	params.meanDependencyDistance = 4;
+	params.registerReuse = 0.3;
+	SyntheticTraceSource chains(params);
+	// Mostly loads and stores, which share one station each.
+	params.mix[0] = 1;
+	params.mix[1] = 1;
+	params.mix[2] = 4;
+	params.mix[3] = 3;
+	params.meanDependencyDistance = 0;
+	params.seed = 2;
+	StreamedTraceSource memory(params);
+
+	bool ok = true;
+	ok = check("width 1", 1, &chains, UINT64_MAX) && ok;
+	ok = check("width 2", 2, &chains, UINT64_MAX) && ok;
+	ok = check("width 4, stepped", 4, &chains, 7) && ok;
+	ok = check("width 3, streamed", 3, &memory, UINT64_MAX) && ok;
+	ok = checkRunner(&chains) && ok;
+	return ok ? 0 : 1;
+}
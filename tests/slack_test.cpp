@@ -0,0 +1,78 @@
+#include <iostream>
+
+#include "cpu.h"
+
+// Checks the slack of a short trace worked out by hand.
+//
+// With width 4, a 4 entry RoB and plenty of registers, the trace below
+// runs as
+//
+//   #  instruction        fetch decode dispatch issue execute complete retire
+//   0  I r2 <- r1 + 0         0      1        2     3       4        5      6
+//   1  S [r5] <- r1           0      1        2     3       4        6      7
+//   2  R r3 <- r2 + r2        0      1        2     5       6        7      8
+//   3  R r4 <- r3 + r3        0      1        4     7       8        9     10
+//   4  R r5 <- r4 + r4        1      2        6     9      10       11     12
+//   5  R r6 <- r5 + r5        1      2        8    11      12       13     14
+//   6  R r7 <- r6 + r6        1      2       10    13      14       15     16
+//   7  R r8 <- r7 + r7        1      2       12    15      16       17     18
+//
+// Everything but 1 is on the critical path. Nothing waits on the store, but
+// its RoB entry is needed by 5, which dispatches into it in cycle 8, so it
+// must retire by then and complete by 7: 1 cycle of slack, not the 11 that
+// waiting only for the last instruction to retire would give. Completing
+// later than 6 would have held up its own retirement, so it has no local
+// slack.
+
+int main() {
+	CPU cpu(32, 64, 4, 4, 16);
+	cpu.setDebugLog(nullptr);
+	cpu.addInstruction('I', 1, 0, 2);
+	cpu.addInstruction('S', 1, 0, 5);
+	for(uint32_t r = 2; r < 8; r++)
+		cpu.addInstruction('R', r, r, r + 1);
+	SlackStats stats(CPUConfig { 32, 64, 4, 4, 16 });
+	cpu.setSlackStats(&stats);
+	cpu.simulate();
+
+	const Cycle expected[8][Stage_COUNT] = {
+		{ 0, 1, 2, 3, 4, 5, 6 },
+		{ 0, 1, 2, 3, 4, 6, 7 },
+		{ 0, 1, 2, 5, 6, 7, 8 },
+		{ 0, 1, 4, 7, 8, 9, 10 },
+		{ 1, 2, 6, 9, 10, 11, 12 },
+		{ 1, 2, 8, 11, 12, 13, 14 },
+		{ 1, 2, 10, 13, 14, 15, 16 },
+		{ 1, 2, 12, 15, 16, 17, 18 }
+	};
+	const Cycle expectedSlack[8] = { 0, 1, 0, 0, 0, 0, 0, 0 };
+	TimingFile timings;
+	cpu.collectTimings(timings);
+	if(timings.getRows().size() != 8) {
+		std::cout << "slack_test: FAILED, " << timings.getRows().size() << " instructions\n";
+		return 1;
+	}
+	for(int i = 0; i < 8; i++) {
+		for(int s = 0; s < Stage_COUNT; s++) {
+			if(timings.getRows()[i].cycles[s] != expected[i][s]) {
+				std::cout << "slack_test: FAILED, instruction " << i << " entered " <<
+						getStageName((TimingStage) s) << " in cycle " <<
+						timings.getRows()[i].cycles[s] << ", not " << expected[i][s] << "\n";
+				return 1;
+			}
+		}
+	}
+
+	std::vector<Cycle> slack, localSlack;
+	stats.getSlack(slack, localSlack);
+	for(int i = 0; i < 8; i++) {
+		if(slack[i] != expectedSlack[i] || localSlack[i] != 0) {
+			std::cout << "slack_test: FAILED, instruction " << i << " has slack " << slack[i] <<
+					" and local slack " << localSlack[i] << ", not " << expectedSlack[i] <<
+					" and 0\n";
+			return 1;
+		}
+	}
+	std::cout << "slack_test: passed\n";
+	return 0;
+}
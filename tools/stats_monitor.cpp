@@ -0,0 +1,135 @@
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "stats_page.h"
+
+// Follows a simulation started with -s stats_file, printing its progress
+// every few seconds until it finishes. Gives up with an error if the
+// simulator's process is gone, or if its cycle count has not moved for -n
+// polls in a row. With -S it instead asks for a state snapshot, which the
+// simulator writes to stats_file.state.
+
+#define DEFAULT_INTERVAL_SECONDS 1.0
+#define DEFAULT_STALLED_POLLS 30
+
+static void usage(const char* program) {
+	std::cout << "Usage : " << program << " [-i seconds] [-n polls] [-S] stats_file\n";
+}
+
+static StatsPageData* mapStatsFile(const char* path) {
+	int fd = open(path, O_RDWR);
+	struct stat st;
+	if(fd < 0 || fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(StatsPageData)) {
+		std::cerr << "Cannot open " << path << "\n";
+		if(fd >= 0)
+			close(fd);
+		return nullptr;
+	}
+	void* map = mmap(nullptr, sizeof(StatsPageData), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(map == MAP_FAILED) {
+		std::cerr << "Cannot map " << path << "\n";
+		return nullptr;
+	}
+	StatsPageData* data = (StatsPageData*) map;
+	if(memcmp(data->magic, STATS_PAGE_MAGIC, sizeof(data->magic)) != 0 ||
+			data->version != STATS_PAGE_VERSION) {
+		std::cerr << path << ": not a stats file\n";
+		munmap(map, sizeof(StatsPageData));
+		return nullptr;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return data;
+}
+
+int main(int argc, char** argv) {
+	double interval = DEFAULT_INTERVAL_SECONDS;
+	uint64_t stalledPolls = DEFAULT_STALLED_POLLS;
+	bool snapshot = false;
+	int arg = 1;
+	for(; arg < argc && argv[arg][0] == '-'; arg++) {
+		if(strcmp(argv[arg], "-i") == 0 && arg + 1 < argc)
+			interval = atof(argv[++arg]);
+		else if(strcmp(argv[arg], "-n") == 0 && arg + 1 < argc)
+			stalledPolls = strtoull(argv[++arg], nullptr, 10);
+		else if(strcmp(argv[arg], "-S") == 0)
+			snapshot = true;
+		else
+			break;
+	}
+	if(argc - arg != 1 || interval <= 0 || stalledPolls < 1) {
+		usage(argv[0]);
+		return 2;
+	}
+	StatsPageData* data = mapStatsFile(argv[arg]);
+	if(data == nullptr)
+		return 1;
+	if(snapshot) {
+		data->snapshotRequested.store(1, std::memory_order_relaxed);
+		std::cout << "Snapshot requested from process " << data->pid << ", see " <<
+				argv[arg] << ".state\n";
+		return 0;
+	}
+
+	std::memory_order relaxed = std::memory_order_relaxed;
+	std::cout << "pid " << data->pid << ": numArchRegs=" << data->config[0] <<
+			" numPhysicalRegs=" << data->config[1] << " robEntries=" << data->config[2] <<
+			" width=" << data->config[3] << " numLSQEntries=" << data->config[4] << "\n";
+	std::cout << std::fixed;
+	uint64_t lastUpdates = UINT64_MAX;
+	uint64_t lastRetired = 0;
+	uint64_t lastNanos = 0;
+	uint64_t lastCycle = UINT64_MAX;
+	uint64_t numStalled = 0;
+	while(true) {
+		uint64_t updates = data->updates.load(relaxed);
+		bool finished = data->finished.load(relaxed);
+		if(updates != lastUpdates) {
+			uint64_t cycle = data->cycle.load(relaxed);
+			uint64_t retired = data->retired.load(relaxed);
+			uint64_t instructions = data->instructions.load(relaxed);
+			uint64_t nanos = data->hostNanos.load(relaxed);
+			uint64_t elapsed = nanos - data->hostStartNanos.load(relaxed);
+			std::cout << "cycle " << cycle << "  retired " << retired;
+			if(instructions)
+				std::cout << " (" << std::setprecision(1) << 100.0 * retired / instructions << "%)";
+			std::cout << std::setprecision(3) << "  IPC " << (cycle ? (double) retired / cycle : 0) <<
+					"  ROB " << data->robOccupancy.load(relaxed) << "/" << data->config[2] <<
+					"  free regs " << data->freeRegisters.load(relaxed);
+			// Host throughput over the whole run and since the last line.
+			std::cout << std::setprecision(2) << "  " <<
+					(elapsed ? retired * 1e3 / elapsed : 0) << " MIPS";
+			if(lastUpdates != UINT64_MAX && nanos > lastNanos)
+				std::cout << " (now " << (retired - lastRetired) * 1e3 / (nanos - lastNanos) << ")";
+			std::cout << "\n" << std::flush;
+			lastUpdates = updates;
+			lastRetired = retired;
+			lastNanos = nanos;
+		}
+		if(finished)
+			break;
+		// EPERM still means the process exists.
+		if(kill((pid_t) data->pid, 0) != 0 && errno == ESRCH) {
+			std::cerr << "Process " << data->pid << " exited before finishing\n";
+			return 1;
+		}
+		uint64_t cycle = data->cycle.load(relaxed);
+		numStalled = cycle == lastCycle ? numStalled + 1 : 0;
+		lastCycle = cycle;
+		if(numStalled >= stalledPolls) {
+			std::cerr << "Process " << data->pid << " has been at cycle " << cycle << " for " <<
+					numStalled << " polls\n";
+			return 1;
+		}
+		usleep((useconds_t) (interval * 1e6));
+	}
+	return 0;
+}
@@ -0,0 +1,436 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "parallel_runner.h"
+
+// Finds the knee of the IPC curve of one trace over robEntries or
+// numPhysicalRegs: the smallest value whose IPC is within a tolerance of
+// the IPC at the top of the range, the rest of the configuration coming
+// from the trace. Rather than a grid, the range is narrowed down by
+// simulating a few evenly spread points per pass over the trace, which is
+// bisection for one point. Prints every sampled point and the knee.
+//
+// Given lists of robEntries and numPhysicalRegs values instead, simulates
+// every combination and marks the ones on the Pareto front of cycles
+// against cost, taken as robEntries + numPhysicalRegs. With -P, all of
+// them run in interleaved chunks, and a configuration is cancelled once
+// a cheaper or equally expensive one is certain to take fewer cycles. The
+// projected cycles come with bounds from the spread of the cycles per
+// instruction of the chunks so far.
+
+#define DEFAULT_TOLERANCE 0.02
+#define DEFAULT_POINTS 3
+#define DEFAULT_MAX_ROB_ENTRIES 512
+#define DEFAULT_MAX_EXTRA_REGS 512
+// Width of the bounds on projected cycles, in standard errors.
+#define DEFAULT_CONFIDENCE 3.0
+// Chunks a configuration runs before it can be cancelled.
+#define MIN_CHUNKS 4
+
+static void usage(const char* program) {
+	std::cout << "Usage : " << program << " [options] trace\n"
+			"  -p parameter      rob (default) or regs\n"
+			"  -l min            smallest value (1 entry or 1 register more than\n"
+			"                    numArchRegs)\n"
+			"  -u max            largest value (" << DEFAULT_MAX_ROB_ENTRIES << " entries or " <<
+			DEFAULT_MAX_EXTRA_REGS << " registers more\n"
+			"                    than numArchRegs)\n"
+			"  -t tolerance      allowed relative IPC loss (" << DEFAULT_TOLERANCE << ")\n"
+			"  -k points         points simulated per pass (" << DEFAULT_POINTS << ")\n"
+			"  -j threads        threads to simulate them on (1)\n"
+			"  -x                extrapolate repeating loops\n"
+			"Grid sweep:\n"
+			"  -R list           robEntries values, e.g. 16,32,64\n"
+			"  -G list           numPhysicalRegs values\n"
+			"  -P                cancel dominated configurations early\n"
+			"  -n cycles         cycles per chunk (" << PARALLEL_RUNNER_CHUNK_CYCLES << ")\n"
+			"  -z z              bounds in standard errors (" << DEFAULT_CONFIDENCE << ")\n";
+}
+
+static bool parseList(const char* arg, std::vector<uint32_t>& values) {
+	char* end;
+	do {
+		values.push_back(strtoul(arg, &end, 10));
+		if(end == arg || (*end != ',' && *end != '\0'))
+			return false;
+		arg = end + 1;
+	} while(*end == ',');
+	return true;
+}
+
+class KneeSearch {
+	TraceSource* source;
+	CPUConfig base;
+	bool sweepRegs;
+	unsigned numThreads;
+	bool extrapolate;
+	// Every point simulated so far.
+	std::map<uint32_t, CPUStats> results;
+	int numPasses;
+public:
+	KneeSearch(TraceSource* source, const CPUConfig& base, bool sweepRegs,
+			unsigned numThreads, bool extrapolate) :
+		source(source), base(base), sweepRegs(sweepRegs), numThreads(numThreads),
+		extrapolate(extrapolate), numPasses(0) {
+	}
+
+	// Simulates the values that have not been simulated yet in one pass.
+	void evaluate(const std::vector<uint32_t>& values) {
+		std::vector<uint32_t> missing;
+		std::vector<CPUConfig> configs;
+		for(uint32_t value : values) {
+			if(results.count(value))
+				continue;
+			CPUConfig config = base;
+			(sweepRegs ? config.numPhysicalRegs : config.robEntries) = value;
+			missing.push_back(value);
+			configs.push_back(config);
+		}
+		if(configs.empty())
+			return;
+		ParallelRunner runner(configs, source);
+		runner.setNumThreads(numThreads);
+		runner.setExtrapolation(extrapolate);
+		runner.simulate();
+		for(size_t i = 0; i < runner.size(); i++)
+			results[missing[i]] = runner.getStats(i);
+		numPasses++;
+	}
+
+	// Stuck configurations count as IPC 0.
+	double getIPC(uint32_t value) {
+		const CPUStats& stats = results[value];
+		return stats.finished ? stats.getIPC() : 0;
+	}
+
+	// Smallest value in [min, max] within tolerance of the IPC at max,
+	// assuming IPC does not drop as the value grows.
+	uint32_t findKnee(uint32_t min, uint32_t max, double tolerance, unsigned numPoints) {
+		evaluate({ min, max });
+		double target = (1 - tolerance) * getIPC(max);
+		if(getIPC(min) >= target)
+			return min;
+		// IPC(lo) < target <= IPC(hi)
+		uint32_t lo = min;
+		uint32_t hi = max;
+		while(hi - lo > 1) {
+			std::vector<uint32_t> points;
+			uint32_t n = std::min<uint32_t>(numPoints, hi - lo - 1);
+			for(uint32_t j = 1; j <= n; j++)
+				points.push_back(lo + (uint64_t) (hi - lo) * j / (n + 1));
+			evaluate(points);
+			for(uint32_t point : points) {
+				if(getIPC(point) >= target) {
+					hi = point;
+					break;
+				}
+				lo = point;
+			}
+		}
+		return hi;
+	}
+
+	void print(std::ostream& out) {
+		out << (sweepRegs ? "numPhysicalRegs" : "robEntries") << "\tcycles\tIPC\n";
+		for(auto& result : results) {
+			out << result.first << "\t" << result.second.cycles << "\t";
+			if(result.second.finished)
+				out << result.second.getIPC() << "\n";
+			else
+				out << "stuck\n";
+		}
+	}
+
+	size_t getNumSimulations() const {
+		return results.size();
+	}
+
+	int getNumPasses() const {
+		return numPasses;
+	}
+};
+
+class GridSweep {
+	struct Point {
+		CPUConfig config;
+		uint64_t cost;
+		// Cycles per instruction of every chunk that retired anything.
+		uint64_t numChunks;
+		double sumCPI;
+		double sumSquaredCPI;
+		Cycle lastCycles;
+		InstrNum lastRetired;
+		bool cancelled;
+		InstrNum cancelledAt;
+		double low;
+		double high;
+	};
+	std::vector<Point> points;
+	ParallelRunner* runner;
+	double confidence;
+	// Otherwise the bounds are on cycles per instruction, which ranks
+	// configurations the same way.
+	bool knownLength;
+
+	// Bounds on the final cycles, or on cycles per instruction for traces
+	// of unknown length.
+	void project(size_t i) {
+		Point& point = points[i];
+		CPUStats stats = runner->getStats(i);
+		if(stats.finished) {
+			point.low = point.high = knownLength ? stats.cycles : 1 / stats.getIPC();
+			return;
+		}
+		double mean = point.sumCPI / point.numChunks;
+		double variance = point.numChunks < 2 ? 0 : (point.sumSquaredCPI -
+				point.numChunks * mean * mean) / (point.numChunks - 1);
+		double error = confidence * std::sqrt(std::max(variance, 0.0) / point.numChunks);
+		point.low = mean - error;
+		point.high = mean + error;
+		if(knownLength) {
+			InstrNum remaining = stats.instructions - stats.retired;
+			point.low = stats.cycles + remaining * std::max(point.low, 0.0);
+			point.high = stats.cycles + remaining * point.high;
+		}
+	}
+public:
+	GridSweep(const std::vector<CPUConfig>& configs, double confidence) :
+		runner(nullptr), confidence(confidence), knownLength(false) {
+		for(const CPUConfig& config : configs) {
+			Point point = Point();
+			point.config = config;
+			point.cost = (uint64_t) config.robEntries + config.numPhysicalRegs;
+			points.push_back(point);
+		}
+	}
+
+	void run(TraceSource* source, Cycle chunkCycles, bool prune, unsigned numThreads,
+			bool extrapolate) {
+		std::vector<CPUConfig> configs;
+		for(Point& point : points)
+			configs.push_back(point.config);
+		knownLength = source->size() != TRACE_SIZE_UNKNOWN;
+		runner = new ParallelRunner(configs, source);
+		runner->setNumThreads(numThreads);
+		runner->setExtrapolation(extrapolate);
+		while(runner->step(chunkCycles)) {
+			for(size_t i = 0; i < points.size(); i++) {
+				CPUStats stats = runner->getStats(i);
+				Point& point = points[i];
+				if(stats.retired > point.lastRetired) {
+					double cpi = (double) (stats.cycles - point.lastCycles) /
+							(stats.retired - point.lastRetired);
+					point.numChunks++;
+					point.sumCPI += cpi;
+					point.sumSquaredCPI += cpi * cpi;
+				}
+				point.lastCycles = stats.cycles;
+				point.lastRetired = stats.retired;
+			}
+			if(prune)
+				cancelDominated();
+		}
+		for(size_t i = 0; i < points.size(); i++)
+			if(!points[i].cancelled && points[i].numChunks)
+				project(i);
+	}
+
+	// A configuration is dominated by another one that costs at most as
+	// much and will take fewer cycles even in the worst case.
+	void cancelDominated() {
+		std::vector<size_t> candidates;
+		for(size_t i = 0; i < points.size(); i++) {
+			if(points[i].cancelled || points[i].numChunks < MIN_CHUNKS)
+				continue;
+			CPUStats stats = runner->getStats(i);
+			if(stats.stuck)
+				continue;
+			project(i);
+			candidates.push_back(i);
+		}
+		for(size_t a : candidates) {
+			if(!runner->isRunning(a))
+				continue;
+			for(size_t b : candidates) {
+				if(b == a || points[b].cancelled || points[b].cost > points[a].cost ||
+						points[b].high >= points[a].low)
+					continue;
+				points[a].cancelled = true;
+				points[a].cancelledAt = runner->getStats(a).retired;
+				runner->cancel(a);
+				break;
+			}
+		}
+	}
+
+	void print(std::ostream& out) {
+		out << "robEntries\tnumPhysicalRegs\tcost\tcycles\tIPC\tstatus\n";
+		for(size_t i = 0; i < points.size(); i++) {
+			const Point& point = points[i];
+			CPUStats stats = runner->getStats(i);
+			out << point.config.robEntries << "\t" << point.config.numPhysicalRegs <<
+					"\t" << point.cost << "\t";
+			if(stats.finished) {
+				out << stats.cycles << "\t" << stats.getIPC() << "\t" <<
+						(isParetoOptimal(i) ? "pareto" : "finished") << "\n";
+			}
+			else if(point.cancelled) {
+				out << "-\t-\tcancelled after " << point.cancelledAt << " instructions, ";
+				if(knownLength)
+					out << "cycles " << (Cycle) point.low << ".." << (Cycle) point.high << "\n";
+				else
+					out << "CPI " << point.low << ".." << point.high << "\n";
+			}
+			else
+				out << stats.cycles << "\t-\tstuck\n";
+		}
+	}
+
+	bool isParetoOptimal(size_t i) {
+		Cycle cycles = runner->getStats(i).cycles;
+		for(size_t j = 0; j < points.size(); j++) {
+			CPUStats other = runner->getStats(j);
+			if(j == i || !other.finished || points[j].cost > points[i].cost ||
+					other.cycles > cycles)
+				continue;
+			if(points[j].cost < points[i].cost || other.cycles < cycles)
+				return false;
+		}
+		return true;
+	}
+
+	~GridSweep() {
+		delete runner;
+	}
+};
+
+int main(int argc, char** argv) {
+	bool sweepRegs = false;
+	uint32_t min = 0;
+	uint32_t max = 0;
+	double tolerance = DEFAULT_TOLERANCE;
+	unsigned numPoints = DEFAULT_POINTS;
+	unsigned numThreads = 1;
+	bool extrapolate = false;
+	std::vector<uint32_t> robValues;
+	std::vector<uint32_t> regValues;
+	bool prune = false;
+	Cycle chunkCycles = PARALLEL_RUNNER_CHUNK_CYCLES;
+	double confidence = DEFAULT_CONFIDENCE;
+	int arg = 1;
+	for(; arg < argc && argv[arg][0] == '-' && argv[arg][1] != '\0' &&
+			argv[arg][2] == '\0'; arg++) {
+		if(argv[arg][1] == 'x' || argv[arg][1] == 'P') {
+			(argv[arg][1] == 'x' ? extrapolate : prune) = true;
+			continue;
+		}
+		if(arg + 1 == argc) {
+			usage(argv[0]);
+			return 1;
+		}
+		const char* value = argv[++arg];
+		switch(argv[arg - 1][1]) {
+		case 'p':
+			if(strcmp(value, "rob") != 0 && strcmp(value, "regs") != 0) {
+				usage(argv[0]);
+				return 1;
+			}
+			sweepRegs = strcmp(value, "regs") == 0;
+			break;
+		case 'l':
+			min = strtoul(value, nullptr, 10);
+			break;
+		case 'u':
+			max = strtoul(value, nullptr, 10);
+			break;
+		case 't':
+			tolerance = atof(value);
+			break;
+		case 'k':
+			numPoints = atoi(value);
+			break;
+		case 'j':
+			numThreads = atoi(value);
+			break;
+		case 'R':
+		case 'G':
+			if(!parseList(value, argv[arg - 1][1] == 'R' ? robValues : regValues)) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'n':
+			chunkCycles = strtoull(value, nullptr, 10);
+			break;
+		case 'z':
+			confidence = atof(value);
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if(argc - arg != 1 || numPoints < 1 || chunkCycles < 1) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	TraceSource* source = openTraceSource(argv[arg]);
+	CPUConfig base;
+	if(source == nullptr || !source->getConfig(base)) {
+		delete source;
+		return 1;
+	}
+	if(!robValues.empty() || !regValues.empty()) {
+		if(robValues.empty())
+			robValues.push_back(base.robEntries);
+		if(regValues.empty())
+			regValues.push_back(base.numPhysicalRegs);
+		std::vector<CPUConfig> configs;
+		for(uint32_t robEntries : robValues) {
+			for(uint32_t numPhysicalRegs : regValues) {
+				CPUConfig config = base;
+				config.robEntries = robEntries;
+				config.numPhysicalRegs = numPhysicalRegs;
+				if(robEntries < 1 || numPhysicalRegs <= base.numArchRegs) {
+					std::cerr << "Invalid configuration " << robEntries << "," <<
+							numPhysicalRegs << "\n";
+					delete source;
+					return 1;
+				}
+				configs.push_back(config);
+			}
+		}
+		GridSweep sweep(configs, confidence);
+		sweep.run(source, chunkCycles, prune, numThreads, extrapolate);
+		sweep.print(std::cout);
+		delete source;
+		return 0;
+	}
+
+	// The free list needs at least one register to rename with.
+	uint32_t lowest = sweepRegs ? base.numArchRegs + 1 : 1;
+	if(min == 0)
+		min = lowest;
+	if(max == 0)
+		max = sweepRegs ? base.numArchRegs + DEFAULT_MAX_EXTRA_REGS : DEFAULT_MAX_ROB_ENTRIES;
+	if(min < lowest || max < min) {
+		std::cerr << "Invalid range " << min << ".." << max << "\n";
+		delete source;
+		return 1;
+	}
+
+	KneeSearch search(source, base, sweepRegs, numThreads, extrapolate);
+	uint32_t knee = search.findKnee(min, max, tolerance, numPoints);
+	search.print(std::cout);
+	std::cout << "knee: " << (sweepRegs ? "numPhysicalRegs " : "robEntries ") << knee <<
+			", IPC " << search.getIPC(knee) << " against " << search.getIPC(max) <<
+			" at " << max << " (" << search.getNumSimulations() << " simulations in " <<
+			search.getNumPasses() << " passes)\n";
+	delete source;
+	return 0;
+}
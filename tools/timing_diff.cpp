@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "parallel_runner.h"
+#include "timing_comparison.h"
+#include "timing_file.h"
+
+// Compares two simulation results, each either a binary timing file or a
+// text output file such as outputs-correct/ex1.txt. Exits with 0 if they
+// match, 1 if they differ and 2 on error.
+//
+// With -t, simulates the trace on two configurations instead, in parallel
+// threads, and compares the results. A configuration is a comma-separated
+// list of CPUConfig fields to change from the trace's, such as
+// robEntries=64,width=2, or "-" to keep it.
+//
+// Where the results differ, reports the deltas (b - a) per stage and per
+// wait between stages, the distribution of per-instruction latency
+// deltas, the instructions that changed most and the regions of the trace
+// that diverge most (see timing_comparison.h).
+
+static void usage(const char* program) {
+	std::cout << "Usage : " << program << " [options] result_a result_b\n"
+			"        " << program << " [options] -t trace config_a config_b\n"
+			"  -g instructions   instructions per region (" << COMPARISON_DEFAULT_REGION << ")\n"
+			"  -k count          instructions and regions listed (" <<
+			COMPARISON_DEFAULT_TOP << ")\n";
+}
+
+static bool parseConfig(const char* spec, CPUConfig& config) {
+	if(strcmp(spec, "-") == 0)
+		return true;
+	std::string fields = spec;
+	size_t pos = 0;
+	while(pos <= fields.size()) {
+		size_t end = std::min(fields.find(',', pos), fields.size());
+		std::string field = fields.substr(pos, end - pos);
+		size_t equals = field.find('=');
+		std::string name = field.substr(0, equals);
+		uint32_t* value = nullptr;
+		if(name == "numArchRegs")
+			value = &config.numArchRegs;
+		else if(name == "numPhysicalRegs")
+			value = &config.numPhysicalRegs;
+		else if(name == "robEntries")
+			value = &config.robEntries;
+		else if(name == "width")
+			value = &config.width;
+		else if(name == "numLSQEntries")
+			value = &config.numLSQEntries;
+		if(value == nullptr || equals == std::string::npos) {
+			std::cerr << "Invalid configuration field \"" << field << "\" in " << spec << "\n";
+			return false;
+		}
+		*value = strtoul(field.c_str() + equals + 1, nullptr, 10);
+		pos = end + 1;
+	}
+	if(config.robEntries < 1 || config.width < 1 || config.numPhysicalRegs <= config.numArchRegs) {
+		std::cerr << "Invalid configuration " << spec << "\n";
+		return false;
+	}
+	return true;
+}
+
+// Simulates the trace at path on both configurations at once.
+static bool simulate(const char* path, const char* specA, const char* specB,
+		TimingFile& a, TimingFile& b) {
+	TraceSource* source = openTraceSource(path);
+	CPUConfig base;
+	if(source == nullptr || !source->getConfig(base)) {
+		delete source;
+		return false;
+	}
+	std::vector<CPUConfig> configs(2, base);
+	if(!parseConfig(specA, configs[0]) || !parseConfig(specB, configs[1])) {
+		delete source;
+		return false;
+	}
+	ParallelRunner runner(configs, source);
+	runner.setNumThreads(2);
+	runner.setTimingHistory(true);
+	runner.simulate();
+	const char* specs[2] = { specA, specB };
+	for(size_t i = 0; i < 2; i++) {
+		if(runner.getStats(i).stuck)
+			std::cout << "configuration " << specs[i] << " got stuck\n";
+	}
+	runner.collectTimings(0, a);
+	runner.collectTimings(1, b);
+	delete source;
+	return true;
+}
+
+static void printRow(const char* label, const TimingRow& row) {
+	std::cout << "  " << label << ":";
+	for(int s = 0; s < Stage_COUNT; s++) {
+		if(row.cycles[s] == CYCLE_UNSET)
+			std::cout << " -";
+		else
+			std::cout << " " << row.cycles[s];
+	}
+	std::cout << "\n";
+}
+
+static bool compareHeaders(const TimingFile& a, const TimingFile& b) {
+	if(!a.isHeaderValid() || !b.isHeaderValid())
+		return true;
+	const TimingFileHeader& ha = a.getHeader();
+	const TimingFileHeader& hb = b.getHeader();
+	bool same = true;
+	if(ha.numArchRegs != hb.numArchRegs || ha.numPhysicalRegs != hb.numPhysicalRegs ||
+			ha.robEntries != hb.robEntries || ha.width != hb.width ||
+			ha.numLSQEntries != hb.numLSQEntries) {
+		std::cout << "config differs: " <<
+				ha.numArchRegs << "/" << ha.numPhysicalRegs << "/" << ha.robEntries << "/" <<
+				ha.width << "/" << ha.numLSQEntries << " vs " <<
+				hb.numArchRegs << "/" << hb.numPhysicalRegs << "/" << hb.robEntries << "/" <<
+				hb.width << "/" << hb.numLSQEntries << "\n";
+		same = false;
+	}
+	if(ha.traceHash != hb.traceHash) {
+		std::cout << "trace hash differs: " << std::hex << ha.traceHash << " vs " <<
+				hb.traceHash << std::dec << " (different input traces)\n";
+		same = false;
+	}
+	return same;
+}
+
+int main(int argc, char** argv) {
+	uint32_t regionSize = COMPARISON_DEFAULT_REGION;
+	size_t numTop = COMPARISON_DEFAULT_TOP;
+	const char* tracePath = nullptr;
+	int arg = 1;
+	for(; arg + 1 < argc && argv[arg][0] == '-' && argv[arg][1] != '\0' &&
+			argv[arg][2] == '\0'; arg += 2) {
+		const char* value = argv[arg + 1];
+		switch(argv[arg][1]) {
+		case 'g':
+			regionSize = strtoul(value, nullptr, 10);
+			break;
+		case 'k':
+			numTop = strtoul(value, nullptr, 10);
+			break;
+		case 't':
+			tracePath = value;
+			break;
+		default:
+			usage(argv[0]);
+			return 2;
+		}
+	}
+	if(argc - arg != 2 || regionSize < 1) {
+		usage(argv[0]);
+		return 2;
+	}
+	TimingFile a, b;
+	bool same = true;
+	// File names, or in -t mode a and b with their configurations.
+	std::string labels[2] = { argv[arg], argv[arg + 1] };
+	if(tracePath) {
+		for(int i = 0; i < 2; i++) {
+			const char* spec = argv[arg + i];
+			labels[i] = std::string(i ? "b" : "a") + " (" +
+					(strcmp(spec, "-") == 0 ? "trace config" : spec) + ")";
+		}
+		if(!simulate(tracePath, argv[arg], argv[arg + 1], a, b))
+			return 2;
+	}
+	else {
+		if(!a.load(argv[arg]) || !b.load(argv[arg + 1]))
+			return 2;
+		same = compareHeaders(a, b);
+	}
+
+	const std::vector<TimingRow>& rowsA = a.getRows();
+	const std::vector<TimingRow>& rowsB = b.getRows();
+	if(rowsA.size() != rowsB.size()) {
+		std::cout << "instruction count differs: " << rowsA.size() << " vs " << rowsB.size() << "\n";
+		same = false;
+	}
+
+	TimingComparison comparison(regionSize, numTop);
+	comparison.compare(rowsA, rowsB);
+	size_t numRows = std::min(rowsA.size(), rowsB.size());
+	TimingStage stage;
+	InstrNum first = comparison.getFirstDivergence(stage);
+	if(first != INSTR_NONE) {
+		same = false;
+		std::cout << "first divergence at instruction " << first <<
+				" (" << getStageName(stage) << ")\n";
+		printRow(labels[0].c_str(), rowsA[first]);
+		printRow(labels[1].c_str(), rowsB[first]);
+		comparison.write(std::cout, rowsA, rowsB);
+	}
+	if(same)
+		std::cout << "identical (" << numRows << " instructions)\n";
+	return same ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "compressed_trace.h"
+#include "cpu.h"
+#include "trace_profile.h"
+
+// Profiles a trace and writes a shorter statistical clone of it (see
+// trace_profile.h), checking that the clone's IPC on the CPU is within a
+// tolerance of the original's on every given configuration. Exits with 0
+// if it is, 1 if no seed got there and 2 on error.
+
+#define DEFAULT_TOLERANCE 0.02
+#define DEFAULT_ATTEMPTS 8
+#define DEFAULT_MIN_LENGTH 100000
+#define DEFAULT_INSTRUCTIONS_PER_BLOCK 65536
+#define BATCH_SIZE 4096
+
+static void usage(const char* program) {
+	std::cout << "Usage : " << program << " [options] input_trace output_trace\n"
+			"  -n length         instructions in the clone\n"
+			"                    (1% of the input, at least " << DEFAULT_MIN_LENGTH << ")\n"
+			"  -t tolerance      allowed relative IPC error (" << DEFAULT_TOLERANCE << ")\n"
+			"  -a attempts       seeds to try (" << DEFAULT_ATTEMPTS << ")\n"
+			"  -s seed           first seed (1)\n"
+			"  -c a,p,r,w,l      configuration to validate on; may be repeated\n"
+			"                    (the input's configuration line)\n"
+			"  -f format         text (default), binary or compressed\n";
+}
+
+static bool parseConfig(const char* arg, CPUConfig& config) {
+	uint32_t* fields[] = { &config.numArchRegs, &config.numPhysicalRegs,
+			&config.robEntries, &config.width, &config.numLSQEntries };
+	char* end;
+	for(int i = 0; i < 5; i++) {
+		*fields[i] = strtoul(arg, &end, 10);
+		if(end == arg || (i < 4 ? *end != ',' : *end != '\0'))
+			return false;
+		arg = end + 1;
+	}
+	return true;
+}
+
+static bool isValid(const CPUConfig& config) {
+	return config.numArchRegs > 0 && config.numPhysicalRegs > config.numArchRegs &&
+			config.robEntries > 0 && config.width > 0;
+}
+
+static void writeConfig(std::ostream& out, const CPUConfig& config) {
+	out << config.numArchRegs << "," << config.numPhysicalRegs << "," << config.robEntries <<
+			"," << config.width << "," << config.numLSQEntries;
+}
+
+// Returns 0 if the CPU got stuck.
+static double simulateIPC(const CPUConfig& config, TraceSource& source) {
+	CPU cpu(config);
+	cpu.setTraceSource(&source);
+	cpu.simulate();
+	CPUStats stats = cpu.getStats();
+	return stats.stuck ? 0 : stats.getIPC();
+}
+
+template <class Writer>
+static bool writeRecords(Writer& writer, TraceSource& source) {
+	StaticInstruction batch[BATCH_SIZE];
+	source.rewind();
+	while(size_t numRead = source.read(batch, BATCH_SIZE))
+		for(size_t i = 0; i < numRead; i++)
+			writer.addInstruction(batch[i]);
+	return writer.close();
+}
+
+static bool writeClone(const char* path, const char* format, const CPUConfig& config,
+		TraceSource& clone) {
+	if(strcmp(format, "binary") == 0) {
+		BinaryTraceWriter writer;
+		return writer.open(path, config) && writeRecords(writer, clone);
+	}
+	if(strcmp(format, "compressed") == 0) {
+		CompressedTraceWriter writer;
+		return writer.open(path, config, DEFAULT_INSTRUCTIONS_PER_BLOCK, 6) &&
+				writeRecords(writer, clone);
+	}
+	TextTraceWriter writer;
+	return writer.open(path, config) && writeRecords(writer, clone);
+}
+
+int main(int argc, char** argv) {
+	InstrNum length = 0;
+	double tolerance = DEFAULT_TOLERANCE;
+	int attempts = DEFAULT_ATTEMPTS;
+	uint64_t seed = 1;
+	std::vector<CPUConfig> configs;
+	const char* format = "text";
+	int arg = 1;
+	for(; arg + 1 < argc && argv[arg][0] == '-' && argv[arg][1] != '\0' &&
+			argv[arg][2] == '\0'; arg += 2) {
+		const char* value = argv[arg + 1];
+		CPUConfig config;
+		switch(argv[arg][1]) {
+		case 'n':
+			length = strtoull(value, nullptr, 10);
+			break;
+		case 't':
+			tolerance = atof(value);
+			break;
+		case 'a':
+			attempts = atoi(value);
+			break;
+		case 's':
+			seed = strtoull(value, nullptr, 10);
+			break;
+		case 'c':
+			if(!parseConfig(value, config)) {
+				usage(argv[0]);
+				return 2;
+			}
+			if(!isValid(config)) {
+				std::cerr << "Invalid configuration " << value << "\n";
+				return 2;
+			}
+			configs.push_back(config);
+			break;
+		case 'f':
+			format = value;
+			break;
+		default:
+			usage(argv[0]);
+			return 2;
+		}
+	}
+	if(argc - arg != 2 || attempts < 1 || (strcmp(format, "text") != 0 &&
+			strcmp(format, "binary") != 0 && strcmp(format, "compressed") != 0)) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	TraceSource* original = openTraceSource(argv[arg]);
+	if(original == nullptr)
+		return 2;
+	TraceProfile profile;
+	if(!profile.build(*original)) {
+		std::cerr << argv[arg] << ": empty trace\n";
+		delete original;
+		return 2;
+	}
+	profile.print(std::cout);
+	if(configs.empty())
+		configs.push_back(profile.config);
+	if(length == 0)
+		length = std::min(profile.numInstructions,
+				std::max<InstrNum>(profile.numInstructions / 100, DEFAULT_MIN_LENGTH));
+
+	std::vector<double> originalIPC;
+	for(const CPUConfig& config : configs) {
+		original->rewind();
+		originalIPC.push_back(simulateIPC(config, *original));
+		if(originalIPC.back() == 0) {
+			// There is no IPC to match.
+			std::cerr << "The original trace gets stuck on ";
+			writeConfig(std::cerr, config);
+			std::cerr << "\n";
+			delete original;
+			return 2;
+		}
+		std::cout << "original IPC " << originalIPC.back() << " on ";
+		writeConfig(std::cout, config);
+		std::cout << "\n";
+	}
+	delete original;
+
+	// Keep the seed whose worst relative error over the configurations is
+	// smallest.
+	uint64_t bestSeed = seed;
+	double bestError = INFINITY;
+	for(int a = 0; a < attempts && bestError > tolerance; a++) {
+		CloneTraceSource clone(profile, length, seed + a);
+		double worst = 0;
+		for(size_t c = 0; c < configs.size(); c++) {
+			clone.rewind();
+			double ipc = simulateIPC(configs[c], clone);
+			worst = std::max(worst, std::fabs(ipc - originalIPC[c]) / originalIPC[c]);
+		}
+		std::cout << "clone seed " << seed + a << ": worst IPC error " << 100 * worst << "%\n";
+		if(worst < bestError) {
+			bestError = worst;
+			bestSeed = seed + a;
+		}
+	}
+
+	CloneTraceSource clone(profile, length, bestSeed);
+	if(!writeClone(argv[arg + 1], format, profile.config, clone)) {
+		std::cerr << "Cannot write " << argv[arg + 1] << "\n";
+		return 2;
+	}
+	std::cout << "wrote " << length << " instructions with seed " << bestSeed <<
+			(bestError <= tolerance ? " (within " : " (outside ") << 100 * tolerance <<
+			"% tolerance)\n";
+	return bestError <= tolerance ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "compressed_trace.h"
+#include "synthetic_trace.h"
+
+// Writes a synthetic trace (see synthetic_trace.h) as an input file, a
+// binary trace or a compressed trace.
+
+#define DEFAULT_INSTRUCTIONS_PER_BLOCK 65536
+#define BATCH_SIZE 4096
+
+static void usage(const char* program) {
+	std::cout << "Usage : " << program << " [options] -n length output_trace\n"
+			"  -n length         number of instructions\n"
+			"  -f format         text (default), binary or compressed\n"
+			"  -c a,p,r,w,l      configuration line: numArchRegs, numPhysicalRegs,\n"
+			"                    robEntries, width, numLSQEntries (32,64,128,2,16)\n"
+			"  -m r,i,l,s        relative weights of R, I, L and S (1,1,1,1)\n"
+			"  -d distance       mean dependency distance, 0 for random sources (0)\n"
+			"  -u fraction       destinations reusing a recent destination (0)\n"
+			"  -w window         destinations considered recent (8)\n"
+			"  -a fraction       loads aliasing a recent store (0)\n"
+			"  -s seed           random seed (1)\n";
+}
+
+static bool parseList(const char* arg, double* values, int count) {
+	char* end;
+	for(int i = 0; i < count; i++) {
+		values[i] = strtod(arg, &end);
+		if(end == arg || (i + 1 < count ? *end != ',' : *end != '\0'))
+			return false;
+		arg = end + 1;
+	}
+	return true;
+}
+
+template <class Writer>
+static bool writeRecords(Writer& writer, TraceSource& source) {
+	StaticInstruction batch[BATCH_SIZE];
+	while(size_t numRead = source.read(batch, BATCH_SIZE))
+		for(size_t i = 0; i < numRead; i++)
+			writer.addInstruction(batch[i]);
+	return writer.close();
+}
+
+int main(int argc, char** argv) {
+	SyntheticTraceParams params;
+	CPUConfig config = { 32, 64, 128, 2, 16 };
+	const char* format = "text";
+	bool hasLength = false;
+	int arg = 1;
+	for(; arg + 1 < argc && argv[arg][0] == '-' && argv[arg][1] != '\0' &&
+			argv[arg][2] == '\0'; arg += 2) {
+		const char* value = argv[arg + 1];
+		double configValues[5];
+		bool ok = true;
+		switch(argv[arg][1]) {
+		case 'n':
+			params.length = strtoull(value, nullptr, 10);
+			hasLength = true;
+			break;
+		case 'f':
+			format = value;
+			break;
+		case 'c':
+			ok = parseList(value, configValues, 5);
+			config = { (uint32_t) configValues[0], (uint32_t) configValues[1],
+					(uint32_t) configValues[2], (uint32_t) configValues[3],
+					(uint32_t) configValues[4] };
+			break;
+		case 'm':
+			ok = parseList(value, params.mix, 4);
+			break;
+		case 'd':
+			params.meanDependencyDistance = atof(value);
+			break;
+		case 'u':
+			params.registerReuse = atof(value);
+			break;
+		case 'w':
+			params.reuseWindow = strtoul(value, nullptr, 10);
+			break;
+		case 'a':
+			params.aliasRate = atof(value);
+			break;
+		case 's':
+			params.seed = strtoull(value, nullptr, 10);
+			break;
+		default:
+			ok = false;
+		}
+		if(!ok) {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+	params.numArchRegs = config.numArchRegs;
+	double mixTotal = params.mix[0] + params.mix[1] + params.mix[2] + params.mix[3];
+	if(argc - arg != 1 || !hasLength || config.numArchRegs == 0 || mixTotal <= 0 ||
+			params.reuseWindow == 0 || params.reuseWindow >= SYNTHETIC_MAX_DEPENDENCY_DISTANCE) {
+		usage(argv[0]);
+		return 2;
+	}
+	const char* path = argv[arg];
+	SyntheticTraceSource source(params);
+
+	bool ok;
+	if(strcmp(format, "text") == 0) {
+		TextTraceWriter writer;
+		ok = writer.open(path, config) && writeRecords(writer, source);
+	}
+	else if(strcmp(format, "binary") == 0) {
+		BinaryTraceWriter writer;
+		ok = writer.open(path, config) && writeRecords(writer, source);
+	}
+	else if(strcmp(format, "compressed") == 0) {
+		CompressedTraceWriter writer;
+		ok = writer.open(path, config, DEFAULT_INSTRUCTIONS_PER_BLOCK, 1) &&
+				writeRecords(writer, source);
+	}
+	else {
+		usage(argv[0]);
+		return 2;
+	}
+	if(!ok) {
+		std::cerr << "Cannot write " << path << "\n";
+		return 1;
+	}
+	return 0;
+}
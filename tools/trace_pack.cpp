@@ -0,0 +1,64 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "compressed_trace.h"
+
+// Converts a trace in any format openTraceSource() reads into a block
+// compressed trace (see compressed_trace.h).
+
+#define DEFAULT_INSTRUCTIONS_PER_BLOCK 65536
+#define DEFAULT_LEVEL 6
+
+static void usage(const char* program) {
+	std::cout << "Usage : " << program <<
+			" [-n instructions_per_block] [-l level] input_trace output_trace\n";
+}
+
+int main(int argc, char** argv) {
+	uint32_t instructionsPerBlock = DEFAULT_INSTRUCTIONS_PER_BLOCK;
+	int level = DEFAULT_LEVEL;
+	int arg = 1;
+	for(; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+		if(strcmp(argv[arg], "-n") == 0)
+			instructionsPerBlock = strtoul(argv[arg + 1], nullptr, 10);
+		else if(strcmp(argv[arg], "-l") == 0)
+			level = atoi(argv[arg + 1]);
+		else
+			break;
+	}
+	if(argc - arg != 2 || instructionsPerBlock == 0 || level < 1 || level > 9) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	TraceSource* source = openTraceSource(argv[arg]);
+	CPUConfig config;
+	if(source == nullptr || !source->getConfig(config)) {
+		std::cerr << argv[arg] << ": trace has no configuration\n";
+		delete source;
+		return 1;
+	}
+	CompressedTraceWriter writer;
+	if(!writer.open(argv[arg + 1], config, instructionsPerBlock, level)) {
+		delete source;
+		return 1;
+	}
+	StaticInstruction batch[1024];
+	InstrNum numInstructions = 0;
+	bool ok = true;
+	while(size_t numRead = source->read(batch, 1024)) {
+		for(size_t i = 0; i < numRead && ok; i++)
+			ok = writer.addInstruction(batch[i]);
+		numInstructions += numRead;
+	}
+	ok = writer.close() && ok;
+	delete source;
+	if(!ok) {
+		std::cerr << "Cannot write " << argv[arg + 1] << "\n";
+		return 1;
+	}
+	std::cout << numInstructions << " instructions in " <<
+			(numInstructions + instructionsPerBlock - 1) / instructionsPerBlock << " blocks\n";
+	return 0;
+}